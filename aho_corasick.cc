@@ -0,0 +1,106 @@
+/****************************************************************************
+ * aho_corasick.cc
+ *
+ *   Copyright (c) 2026 Yoshinori Sugino
+ *   This software is released under the MIT License.
+ ****************************************************************************/
+#include "aho_corasick.h"
+
+#include <cstring>
+
+namespace util {
+
+constexpr uint32_t AhoCorasick::kMatchFlag;
+
+namespace {
+
+constexpr uint32_t kNoState = UINT32_MAX;
+
+}  // namespace
+
+AhoCorasick::AhoCorasick(const std::vector<std::string> &patterns)
+  : class_count_(1),
+    byte_class_(),
+    transitions_(),
+    output_begin_(),
+    output_ids_(),
+    row_(0) {
+  // Bytes which occur in no pattern all behave alike and share class 0
+  std::memset(byte_class_, 0, sizeof(byte_class_));
+  for (const auto &pattern : patterns) {
+    for (auto c : pattern) {
+      auto &byte_class = byte_class_[static_cast<uint8_t>(c)];
+      if (byte_class == 0) byte_class = class_count_++;
+    }
+  }
+
+  // Trie
+  std::vector<uint32_t> next(class_count_, kNoState);
+  std::vector<std::vector<uint32_t>> outputs(1);
+  for (uint32_t id = 0; id < patterns.size(); ++id) {
+    uint32_t state = 0;
+    for (auto c : patterns[id]) {
+      auto index = state * class_count_ + byte_class_[static_cast<uint8_t>(c)];
+      if (next[index] == kNoState) {
+        next[index] = outputs.size();
+        outputs.emplace_back();
+        next.resize(next.size() + class_count_, kNoState);
+      }
+      state = next[index];
+    }
+    // An empty pattern would match between any two bytes
+    if (state != 0) outputs[state].push_back(id);
+  }
+
+  // Failure links in breadth-first order turn the trie into a DFA
+  auto state_count = outputs.size();
+  std::vector<uint32_t> failure(state_count, 0);
+  std::vector<uint32_t> queue;
+  queue.reserve(state_count);
+  for (uint32_t c = 0; c < class_count_; ++c) {
+    auto &target = next[c];
+    if (target == kNoState) {
+      target = 0;
+    } else {
+      queue.push_back(target);
+    }
+  }
+  for (size_t i = 0; i < queue.size(); ++i) {
+    auto state = queue[i];
+    const auto &inherited = outputs[failure[state]];
+    outputs[state].insert(outputs[state].end(), inherited.begin(),
+                          inherited.end());
+    for (uint32_t c = 0; c < class_count_; ++c) {
+      auto &target = next[state * class_count_ + c];
+      auto fallback = next[failure[state] * class_count_ + c];
+      if (target == kNoState) {
+        target = fallback;
+      } else {
+        failure[target] = fallback;
+        queue.push_back(target);
+      }
+    }
+  }
+
+  transitions_.resize(next.size());
+  for (size_t i = 0; i < next.size(); ++i) {
+    transitions_[i] = next[i] * class_count_;
+    if (!outputs[next[i]].empty()) transitions_[i] |= kMatchFlag;
+  }
+  output_begin_.reserve(state_count + 1);
+  for (const auto &ids : outputs) {
+    output_begin_.push_back(output_ids_.size());
+    output_ids_.insert(output_ids_.end(), ids.begin(), ids.end());
+  }
+  output_begin_.push_back(output_ids_.size());
+}
+
+void AhoCorasick::Reset() {
+  row_ = 0;
+}
+
+size_t AhoCorasick::StateCount() const {
+  return output_begin_.size() - 1;
+}
+
+}  // namespace util
@@ -0,0 +1,67 @@
+/****************************************************************************
+ * aho_corasick.h
+ *
+ *   Copyright (c) 2026 Yoshinori Sugino
+ *   This software is released under the MIT License.
+ ****************************************************************************/
+#ifndef AHO_CORASICK_H_
+#define AHO_CORASICK_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace util {
+
+// Finds any of a set of patterns in a byte stream in one pass.
+// The patterns are compiled into a DFA over byte classes, so each input
+// byte costs two table lookups. Matches may span several chunks.
+class AhoCorasick final {
+ public:
+  AhoCorasick() = delete;
+  explicit AhoCorasick(const std::vector<std::string> &patterns);
+
+  // Calls on_match(pattern_index) for every occurrence of every pattern
+  // which ends in data
+  template <typename F>
+  void Scan(const uint8_t *data, size_t size, F on_match);
+  // Forgets partial matches
+  void Reset();
+
+  size_t StateCount() const;
+
+ private:
+  // Set in a transition whose target state completes a pattern
+  static constexpr uint32_t kMatchFlag = 0x80000000;
+
+  uint32_t class_count_;
+  uint8_t byte_class_[256];
+  // Indexed by row + class; a row is state * class_count_.
+  // Each entry is the row of the target state, maybe with kMatchFlag.
+  std::vector<uint32_t> transitions_;
+  // Patterns completed in state s are
+  // output_ids_[output_begin_[s], output_begin_[s + 1])
+  std::vector<uint32_t> output_begin_;
+  std::vector<uint32_t> output_ids_;
+  uint32_t row_;
+};
+
+template <typename F>
+void AhoCorasick::Scan(const uint8_t *data, size_t size, F on_match) {
+  auto row = row_;
+  for (size_t i = 0; i < size; ++i) {
+    auto next = transitions_[row + byte_class_[data[i]]];
+    row = next & ~kMatchFlag;
+    if (next & kMatchFlag) {
+      auto state = row / class_count_;
+      for (auto j = output_begin_[state]; j < output_begin_[state + 1]; ++j)
+        on_match(output_ids_[j]);
+    }
+  }
+  row_ = row;
+}
+
+}  // namespace util
+
+#endif  // AHO_CORASICK_H_
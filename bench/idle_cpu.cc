@@ -0,0 +1,52 @@
+/****************************************************************************
+ * bench/idle_cpu.cc
+ *
+ *   Measures the CPU time stermcom consumes on an idle console.
+ *
+ *   Copyright (c) 2026 Yoshinori Sugino
+ *   This software is released under the MIT License.
+ ****************************************************************************/
+#include <unistd.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "pty_harness.h"
+
+int main(int argc, char *argv[]) {
+  uint32_t seconds = 3;
+
+  int opt_char;
+  while ((opt_char = getopt(argc, argv, "+d:")) != -1) {
+    if (opt_char == 'd') {
+      seconds = std::atoi(optarg);
+    } else {
+      return EXIT_FAILURE;
+    }
+  }
+  if (optind >= argc) {
+    printf("USAGE: %s [-d seconds] stermcom [options]\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  std::vector<std::string> options(argv + optind + 1, argv + argc);
+  bench::PtySession session(argv[optind], options);
+  if (!session.WaitReady(5000)) {
+    printf("stermcom did not start\n");
+    return EXIT_FAILURE;
+  }
+
+  auto start = bench::NowNs();
+  sleep(seconds);
+  struct rusage usage;
+  if (!session.Stop(&usage)) return EXIT_FAILURE;
+  auto elapsed = (bench::NowNs() - start) / 1e9;
+
+  auto cpu = bench::CpuSeconds(usage);
+  printf("{\"bench\": \"idle_cpu\", \"seconds\": %.3f, "
+         "\"cpu_seconds\": %.3f, \"cpu_percent\": %.2f}\n",
+         elapsed, cpu, cpu / elapsed * 100);
+  return EXIT_SUCCESS;
+}
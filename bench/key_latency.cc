@@ -0,0 +1,104 @@
+/****************************************************************************
+ * bench/key_latency.cc
+ *
+ *   Measures the time from a key press on the terminal until the byte
+ *   can be read from the device, as percentiles over many keys.
+ *
+ *   Copyright (c) 2026 Yoshinori Sugino
+ *   This software is released under the MIT License.
+ ****************************************************************************/
+#include <poll.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "pty_harness.h"
+
+namespace {
+
+double percentileUs(const std::vector<uint64_t> &sorted_ns, double p) {
+  if (sorted_ns.empty()) return 0;
+  auto index = static_cast<size_t>(p / 100 * (sorted_ns.size() - 1) + 0.5);
+  return sorted_ns[index] / 1e3;
+}
+
+}  // namespace
+
+int main(int argc, char *argv[]) {
+  uint32_t count    = 2000;
+  uint32_t gap_us   = 500;
+
+  int opt_char;
+  while ((opt_char = getopt(argc, argv, "+n:g:")) != -1) {
+    if (opt_char == 'n') {
+      count = std::atoi(optarg);
+    } else if (opt_char == 'g') {
+      gap_us = std::atoi(optarg);
+    } else {
+      return EXIT_FAILURE;
+    }
+  }
+  if (optind >= argc || count == 0) {
+    printf("USAGE: %s [-n keys] [-g gap_us] stermcom [options]\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  std::vector<std::string> options(argv + optind + 1, argv + argc);
+  bench::PtySession session(argv[optind], options);
+  if (!session.WaitReady(5000)) {
+    printf("stermcom did not start\n");
+    return EXIT_FAILURE;
+  }
+
+  // The echo on the terminal is thrown away
+  uint8_t sink[4096];
+
+  std::vector<uint64_t> latencies;
+  latencies.reserve(count);
+  uint32_t lost = 0;
+  for (uint32_t i = 0; i < count; ++i) {
+    uint8_t key = 'a' + i % 26;
+    auto start = bench::NowNs();
+    if (write(session.terminal(), &key, 1) != 1) {
+      ++lost;
+      continue;
+    }
+
+    bool is_received = false;
+    while (!is_received) {
+      struct pollfd pfd = {session.device(), POLLIN, 0};
+      if (poll(&pfd, 1, 1000) <= 0) break;
+      uint8_t byte;
+      while (read(session.device(), &byte, 1) == 1) {
+        if (byte == key) is_received = true;
+      }
+    }
+    if (!is_received) {
+      ++lost;
+      continue;
+    }
+    latencies.push_back(bench::NowNs() - start);
+    while (read(session.terminal(), sink, sizeof(sink)) > 0) {
+    }
+    usleep(gap_us);
+  }
+
+  struct rusage usage;
+  if (!session.Stop(&usage)) return EXIT_FAILURE;
+
+  std::sort(latencies.begin(), latencies.end());
+  printf("{\"bench\": \"key_latency\", \"options\": \"%s\", \"keys\": %u, "
+         "\"lost\": %u, \"p50_us\": %.1f, \"p90_us\": %.1f, "
+         "\"p99_us\": %.1f, \"p999_us\": %.1f, \"max_us\": %.1f, "
+         "\"peak_rss_kb\": %llu}\n",
+         bench::JoinOptions(options).c_str(), count, lost,
+         percentileUs(latencies, 50), percentileUs(latencies, 90),
+         percentileUs(latencies, 99), percentileUs(latencies, 99.9),
+         percentileUs(latencies, 100),
+         static_cast<unsigned long long>(bench::PeakRssKb(usage)));
+  return lost == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,258 @@
+/****************************************************************************
+ * bench/micro.cc
+ *
+ *   Measures the time and heap allocations per call of the key decoder,
+ *   the history reader, its reverse search and the history writer in
+ *   isolation. Fails if a call on the path of a key allocates.
+ *
+ *   Copyright (c) 2026 Yoshinori Sugino
+ *   This software is released under the MIT License.
+ ****************************************************************************/
+#include <unistd.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "history_reader.h"
+#include "history_writer.h"
+#include "pty_harness.h"
+#include "read_key.h"
+
+namespace {
+
+// The benchmark is single threaded
+uint64_t allocation_count = 0;
+
+}  // namespace
+
+void *operator new(size_t size) {
+  ++allocation_count;
+  auto p = std::malloc(size == 0 ? 1 : size);
+  if (p == nullptr) throw std::bad_alloc();
+  return p;
+}
+
+void *operator new[](size_t size) {
+  return operator new(size);
+}
+
+void operator delete(void *p) noexcept {
+  std::free(p);
+}
+
+void operator delete[](void *p) noexcept {
+  std::free(p);
+}
+
+namespace {
+
+struct Result {
+  uint64_t iterations;
+  double ns_per_op;
+  double allocs_per_op;
+};
+
+// Runs op until min_ns has passed. setup is run before each call and is
+// not measured, nor is the first call, which allocates what is kept.
+Result measure(const std::function<void()> &setup,
+               const std::function<void()> &op, uint64_t min_ns) {
+  if (setup) setup();
+  op();
+
+  Result result = {0, 0, 0};
+  uint64_t measured_ns = 0;
+  uint64_t allocations = 0;
+  while (measured_ns < min_ns || result.iterations < 3) {
+    if (setup) setup();
+    auto allocations_before = allocation_count;
+    auto start = bench::NowNs();
+    op();
+    measured_ns += bench::NowNs() - start;
+    allocations += allocation_count - allocations_before;
+    ++result.iterations;
+  }
+  result.ns_per_op = static_cast<double>(measured_ns) / result.iterations;
+  result.allocs_per_op = static_cast<double>(allocations) / result.iterations;
+  return result;
+}
+
+void printResult(const char *function, size_t size, const char *unit,
+                 const Result &result) {
+  printf("{\"bench\": \"micro\", \"function\": \"%s\", \"size\": %zu, "
+         "\"unit\": \"%s\", \"iterations\": %llu, \"ns_per_op\": %.1f, "
+         "\"allocs_per_op\": %.2f}\n",
+         function, size, unit,
+         static_cast<unsigned long long>(result.iterations),
+         result.ns_per_op, result.allocs_per_op);
+}
+
+// Calls on the path of a key must not allocate
+bool isAllocationFree(const char *function, const Result &result) {
+  if (result.allocs_per_op == 0) return true;
+  fprintf(stderr, "%s allocates %.2f times per call\n", function,
+          result.allocs_per_op);
+  return false;
+}
+
+// Typed text with cursor keys, Enter and a bracketed paste in between
+std::vector<uint8_t> keyInput(size_t size) {
+  static const char kPattern[] =
+      "ls -la\r\x1b[A\x1b[A\x1b[B\r"
+      "\x1b[200~echo pasted text\r\x1b[201~"
+      "cat /proc/cpuinfo\x7f\x7f\x1b[D\x1b[C\r";
+  std::vector<uint8_t> input;
+  while (input.size() < size) {
+    input.push_back(kPattern[input.size() % (sizeof(kPattern) - 1)]);
+  }
+  return input;
+}
+
+bool writeLines(const std::string &path, size_t lines) {
+  auto fp = std::fopen(path.c_str(), "w");
+  if (fp == nullptr) return false;
+  for (size_t i = 0; i < lines; ++i) {
+    std::fprintf(fp, "echo history line %08zu with some arguments\n", i);
+  }
+  return std::fclose(fp) == 0;
+}
+
+}  // namespace
+
+int main(int argc, char *argv[]) {
+  uint64_t min_ms = 200;
+
+  int opt_char;
+  while ((opt_char = getopt(argc, argv, "t:")) != -1) {
+    if (opt_char == 't') {
+      min_ms = std::atoi(optarg);
+    } else {
+      printf("USAGE: %s [-t min_ms_per_case]\n", argv[0]);
+      return EXIT_FAILURE;
+    }
+  }
+  auto min_ns = min_ms * 1000000;
+  bool is_allocation_free = true;
+
+  for (size_t size : {16, 256, 4096}) {
+    auto input = keyInput(size);
+    util::KeyDecoder decoder;
+    size_t events = 0;
+    auto result = measure(nullptr, [&]() {
+      events += decoder.Feed(input.data(), input.size()).size();
+    }, min_ns);
+    if (events == 0) return EXIT_FAILURE;
+    printResult("KeyDecoder::Feed", size, "bytes", result);
+    is_allocation_free &= isAllocationFree("KeyDecoder::Feed", result);
+  }
+
+  char path_template[] = "/tmp/stermcom-micro-XXXXXX";
+  auto fd = mkstemp(path_template);
+  if (fd < 0) {
+    printf("cannot create a temporary file\n");
+    return EXIT_FAILURE;
+  }
+  close(fd);
+  std::string path(path_template);
+
+  // Recalls the newest line and the one before, as the Up key does
+  for (size_t lines : {100, 1000, 10000}) {
+    if (!writeLines(path, lines)) return EXIT_FAILURE;
+    util::HistoryReader reader(path, lines);
+    size_t recalled = 0;
+    auto result = measure(nullptr, [&]() {
+      reader.StartSearch();
+      reader.Up();
+      recalled += reader.ClearHistoryLine().count;
+      reader.Up();
+      recalled += reader.At().size;
+      reader.EndSearch();
+    }, min_ns);
+    if (recalled == 0) return EXIT_FAILURE;
+    printResult("HistoryReader::StartSearch+Up+At", lines, "lines", result);
+    is_allocation_free &=
+        isAllocationFree("HistoryReader::StartSearch+Up+At", result);
+  }
+
+  // Another session has added a line before each search
+  for (size_t lines : {100, 1000, 10000}) {
+    if (!writeLines(path, lines)) return EXIT_FAILURE;
+    util::HistoryReader reader(path, lines);
+    reader.StartSearch();
+    reader.EndSearch();
+    bool is_ok = true;
+    auto result = measure([&]() {
+      auto fp = std::fopen(path.c_str(), "a");
+      is_ok = is_ok && fp != nullptr && std::fputs("appended\n", fp) >= 0 &&
+              std::fclose(fp) == 0;
+    }, [&]() {
+      reader.StartSearch();
+      reader.Up();
+      is_ok = is_ok && reader.At().size == 8;
+      reader.EndSearch();
+    }, min_ns);
+    if (!is_ok) return EXIT_FAILURE;
+    printResult("HistoryReader::StartSearch+Up+At after append", lines,
+                "lines", result);
+  }
+
+  // Types a query which narrows the reverse search from the newest line to
+  // an old one, one byte per key
+  for (size_t lines : {100, 10000, 100000}) {
+    if (!writeLines(path, lines)) return EXIT_FAILURE;
+    util::HistoryReader reader(path, lines);
+    const std::string query("line 00000042 w");
+    bool is_ok = true;
+    auto search = [&]() {
+      reader.StartReverseSearch();
+      for (size_t i = 0; i < query.size(); ++i) {
+        reader.AddSearchBytes(
+            {reinterpret_cast<const uint8_t *>(&query[i]), 1});
+      }
+      is_ok = is_ok && !reader.IsSearchFailing();
+      reader.EndSearch();
+    };
+    // The index is built by the first search, which is not measured
+    auto result = measure(nullptr, search, min_ns);
+    if (!is_ok) return EXIT_FAILURE;
+    result.ns_per_op /= query.size();
+    result.allocs_per_op /= query.size();
+    printResult("HistoryReader::AddSearchBytes", lines, "lines", result);
+    is_allocation_free &=
+        isAllocationFree("HistoryReader::AddSearchBytes", result);
+  }
+
+  // Adds a line to a history of the given size, which is rotated every
+  // time it is full. The line is appended at once, or queued to be
+  // appended in a batch later.
+  const std::string line("echo history line with some arguments");
+  const util::ByteView line_view{
+      reinterpret_cast<const uint8_t *>(line.data()), line.size()};
+  for (auto sync_policy :
+       {util::history_sync_t::kEveryLine, util::history_sync_t::kOnExit}) {
+    for (size_t lines : {100, 10000, 100000}) {
+      (void)unlink(path.c_str());
+      util::HistoryWriter writer(path, lines, sync_policy);
+      bool is_ok = true;
+      auto result = measure(nullptr, [&]() {
+        writer.AddStr(line_view);
+        is_ok = is_ok && writer.Write() == common::status_t::kSuccess;
+      }, min_ns);
+      if (!is_ok) return EXIT_FAILURE;
+      auto function = sync_policy == util::history_sync_t::kEveryLine
+                          ? "HistoryWriter::AddStr+Write"
+                          : "HistoryWriter::AddStr+Write batched";
+      printResult(function, lines, "lines", result);
+      is_allocation_free &= isAllocationFree(function, result);
+    }
+  }
+
+  unlink(path.c_str());
+  unlink((path + ".1").c_str());
+  unlink((path + ".lock").c_str());
+  return is_allocation_free ? EXIT_SUCCESS : EXIT_FAILURE;
+}
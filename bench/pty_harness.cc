@@ -0,0 +1,187 @@
+/****************************************************************************
+ * bench/pty_harness.cc
+ *
+ *   Copyright (c) 2026 Yoshinori Sugino
+ *   This software is released under the MIT License.
+ ****************************************************************************/
+#include "pty_harness.h"
+
+#include <fcntl.h>
+#include <pty.h>
+#include <sys/wait.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include <csignal>
+#include <cstdlib>
+#include <ctime>
+
+namespace bench {
+
+constexpr uint32_t PtySession::kPipeStdout;
+constexpr uint32_t PtySession::kPipeStdin;
+constexpr uint32_t PtySession::kNonblockStdout;
+
+PtySession::PtySession(const std::string &program,
+                       const std::vector<std::string> &options,
+                       uint32_t flags, const std::string &stdin_path)
+  : pid_(-1),
+    terminal_fd_(-1),
+    device_fd_(-1),
+    device_slave_fd_(-1),
+    output_fd_(-1),
+    input_fd_(-1),
+    device_path_() {
+  if (openpty(&device_fd_, &device_slave_fd_, nullptr, nullptr, nullptr) ==
+      -1)
+    return;
+  device_path_ = ttyname(device_slave_fd_);
+
+  int32_t pipe_fds[2] = {-1, -1};
+  if ((flags & kPipeStdout) && pipe(pipe_fds) == -1) return;
+  int32_t input_fds[2] = {-1, -1};
+  if ((flags & kPipeStdin) && pipe(input_fds) == -1) return;
+
+  pid_ = forkpty(&terminal_fd_, nullptr, nullptr, nullptr);
+  if (pid_ > 0) {
+    // The benchmarks must never block on one side while stermcom waits on
+    // the other
+    fcntl(terminal_fd_, F_SETFL, fcntl(terminal_fd_, F_GETFL) | O_NONBLOCK);
+    fcntl(device_fd_, F_SETFL, fcntl(device_fd_, F_GETFL) | O_NONBLOCK);
+    if (pipe_fds[0] != -1) {
+      close(pipe_fds[1]);
+      output_fd_ = pipe_fds[0];
+      fcntl(output_fd_, F_SETFL, fcntl(output_fd_, F_GETFL) | O_NONBLOCK);
+    }
+    if (input_fds[1] != -1) {
+      close(input_fds[0]);
+      input_fd_ = input_fds[1];
+      fcntl(input_fd_, F_SETFL, fcntl(input_fd_, F_GETFL) | O_NONBLOCK);
+    }
+  }
+  if (pid_ == 0) {
+    if (pipe_fds[1] != -1) {
+      if (flags & kNonblockStdout)
+        fcntl(pipe_fds[1], F_SETFL, fcntl(pipe_fds[1], F_GETFL) | O_NONBLOCK);
+      dup2(pipe_fds[1], STDOUT_FILENO);
+      close(pipe_fds[0]);
+      close(pipe_fds[1]);
+    }
+    if (input_fds[0] != -1) {
+      dup2(input_fds[0], STDIN_FILENO);
+      close(input_fds[0]);
+      close(input_fds[1]);
+    } else if (!stdin_path.empty()) {
+      auto fd = open(stdin_path.c_str(), O_RDONLY);
+      if (fd == -1) _exit(127);
+      dup2(fd, STDIN_FILENO);
+      close(fd);
+    }
+    std::vector<char *> argv;
+    argv.push_back(const_cast<char *>(program.c_str()));
+    for (const auto &option : options)
+      argv.push_back(const_cast<char *>(option.c_str()));
+    argv.push_back(const_cast<char *>(device_path_.c_str()));
+    argv.push_back(nullptr);
+    execv(program.c_str(), argv.data());
+    _exit(127);
+  }
+}
+
+PtySession::~PtySession() {
+  if (pid_ > 0) (void)Stop(nullptr);
+  if (terminal_fd_ != -1) close(terminal_fd_);
+  if (device_fd_ != -1) close(device_fd_);
+  if (device_slave_fd_ != -1) close(device_slave_fd_);
+  if (output_fd_ != -1) close(output_fd_);
+  CloseInput();
+}
+
+void PtySession::CloseInput() {
+  if (input_fd_ != -1) close(input_fd_);
+  input_fd_ = -1;
+}
+
+bool PtySession::WaitReady(uint32_t timeout_ms) {
+  if (pid_ <= 0) return false;
+
+  auto deadline = NowNs() + static_cast<uint64_t>(timeout_ms) * 1000000;
+  while (NowNs() < deadline) {
+    struct termios term;
+    if (tcgetattr(device_slave_fd_, &term) == 0 &&
+        (term.c_lflag & ICANON) == 0) {
+      // Requests stermcom sends to its terminal on startup (e.g. bracketed
+      // paste mode) are no data to be measured
+      usleep(20000);
+      uint8_t sink[4096];
+      while (read(terminal_fd_, sink, sizeof(sink)) > 0) {
+      }
+      return true;
+    }
+    if (waitpid(pid_, nullptr, WNOHANG) == pid_) {
+      pid_ = -1;
+      return false;
+    }
+    usleep(1000);
+  }
+  return false;
+}
+
+bool PtySession::Stop(struct rusage *usage) {
+  if (pid_ <= 0) return false;
+
+  kill(pid_, SIGTERM);
+  struct rusage local_usage;
+  int32_t status;
+  auto ret = wait4(pid_, &status, 0, usage ? usage : &local_usage);
+  pid_ = -1;
+  return ret != -1;
+}
+
+bool PtySession::Stop(struct rusage *usage, uint32_t timeout_ms) {
+  if (pid_ <= 0) return false;
+
+  kill(pid_, SIGTERM);
+  struct rusage local_usage;
+  int32_t status;
+  auto deadline = NowNs() + static_cast<uint64_t>(timeout_ms) * 1000000;
+  while (NowNs() < deadline) {
+    auto ret = wait4(pid_, &status, WNOHANG, usage ? usage : &local_usage);
+    if (ret != 0) {
+      pid_ = -1;
+      return ret != -1;
+    }
+    usleep(10000);
+  }
+
+  kill(pid_, SIGKILL);
+  (void)wait4(pid_, &status, 0, usage ? usage : &local_usage);
+  pid_ = -1;
+  return false;
+}
+
+uint64_t NowNs() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return static_cast<uint64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+double CpuSeconds(const struct rusage &usage) {
+  return usage.ru_utime.tv_sec + usage.ru_utime.tv_usec / 1e6 +
+         usage.ru_stime.tv_sec + usage.ru_stime.tv_usec / 1e6;
+}
+
+uint64_t PeakRssKb(const struct rusage &usage) {
+  return usage.ru_maxrss;
+}
+
+std::string JoinOptions(const std::vector<std::string> &options) {
+  std::string joined;
+  for (const auto &option : options) {
+    if (!joined.empty()) joined += " ";
+    joined += option;
+  }
+  return joined;
+}
+
+}  // namespace bench
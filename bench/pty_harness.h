@@ -0,0 +1,76 @@
+/****************************************************************************
+ * bench/pty_harness.h
+ *
+ *   Copyright (c) 2026 Yoshinori Sugino
+ *   This software is released under the MIT License.
+ ****************************************************************************/
+#ifndef BENCH_PTY_HARNESS_H_
+#define BENCH_PTY_HARNESS_H_
+
+#include <sys/resource.h>
+#include <sys/types.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace bench {
+
+// Runs stermcom with two pseudo terminals. One is its controlling terminal
+// (stdin/stdout) and the other stands in for the serial device.
+class PtySession final {
+ public:
+  // stdout of stermcom is a pipe instead of its terminal
+  static constexpr uint32_t kPipeStdout     = 0x1;
+  // stdin of stermcom is a pipe fed through input()
+  static constexpr uint32_t kPipeStdin      = 0x2;
+  // The pipe of kPipeStdout is handed over non-blocking
+  static constexpr uint32_t kNonblockStdout = 0x4;
+
+  // stdin_path redirects stdin of stermcom from a file
+  PtySession(const std::string &program,
+             const std::vector<std::string> &options, uint32_t flags = 0,
+             const std::string &stdin_path = "");
+  ~PtySession();
+  PtySession(const PtySession &) = delete;
+  PtySession &operator=(const PtySession &) = delete;
+
+  // Waits until stermcom has switched the device into raw mode, and
+  // discards what it has written to the terminal until then
+  bool WaitReady(uint32_t timeout_ms);
+  // Sends SIGTERM and reaps the child
+  bool Stop(struct rusage *usage);
+  // Like Stop(), but kills the child and returns false if it has not
+  // exited within timeout_ms
+  bool Stop(struct rusage *usage, uint32_t timeout_ms);
+
+  int32_t terminal() const { return terminal_fd_; }
+  int32_t device() const { return device_fd_; }
+  // Where the output of stermcom arrives
+  int32_t output() const {
+    return output_fd_ != -1 ? output_fd_ : terminal_fd_;
+  }
+  // Write end of the stdin pipe (kPipeStdin)
+  int32_t input() const { return input_fd_; }
+  void CloseInput();
+  const std::string &device_path() const { return device_path_; }
+
+ private:
+  pid_t pid_;
+  int32_t terminal_fd_;
+  int32_t device_fd_;
+  int32_t device_slave_fd_;
+  int32_t output_fd_;
+  int32_t input_fd_;
+  std::string device_path_;
+};
+
+uint64_t NowNs();
+double CpuSeconds(const struct rusage &usage);
+// Peak resident set size in KiB
+uint64_t PeakRssKb(const struct rusage &usage);
+std::string JoinOptions(const std::vector<std::string> &options);
+
+}  // namespace bench
+
+#endif  // BENCH_PTY_HARNESS_H_
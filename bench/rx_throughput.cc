@@ -0,0 +1,89 @@
+/****************************************************************************
+ * bench/rx_throughput.cc
+ *
+ *   Measures how fast stermcom forwards data from the device to stdout,
+ *   and how much CPU time it spends per MB.
+ *
+ *   Copyright (c) 2026 Yoshinori Sugino
+ *   This software is released under the MIT License.
+ ****************************************************************************/
+#include <poll.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "pty_harness.h"
+
+int main(int argc, char *argv[]) {
+  uint64_t size = 16 << 20;
+  uint32_t flags = 0;
+
+  int opt_char;
+  while ((opt_char = getopt(argc, argv, "+m:p")) != -1) {
+    if (opt_char == 'm') {
+      size = std::strtoull(optarg, nullptr, 10) << 20;
+    } else if (opt_char == 'p') {
+      flags |= bench::PtySession::kPipeStdout;
+    } else {
+      return EXIT_FAILURE;
+    }
+  }
+  if (optind >= argc) {
+    printf("USAGE: %s [-m MiB] [-p] stermcom [options]\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  std::vector<std::string> options(argv + optind + 1, argv + argc);
+  bench::PtySession session(argv[optind], options, flags);
+  if (!session.WaitReady(5000)) {
+    printf("stermcom did not start\n");
+    return EXIT_FAILURE;
+  }
+
+  std::vector<uint8_t> pattern(64 * 1024);
+  for (size_t i = 0; i < pattern.size(); ++i) pattern[i] = 'a' + i % 26;
+  std::vector<uint8_t> sink(64 * 1024);
+
+  uint64_t sent = 0, received = 0;
+  auto start    = bench::NowNs();
+  auto deadline = start + 60ull * 1000000000;
+
+  while (received < size && bench::NowNs() < deadline) {
+    struct pollfd pfds[2] = {
+      {session.output(), POLLIN, 0},
+      {session.device(), static_cast<int16_t>(sent < size ? POLLOUT : 0), 0},
+    };
+    if (poll(pfds, 2, 1000) <= 0) continue;
+
+    if (pfds[1].revents & POLLOUT) {
+      auto len = std::min<uint64_t>(pattern.size(), size - sent);
+      auto ret = write(session.device(), pattern.data(), len);
+      if (ret > 0) sent += ret;
+    }
+    if (pfds[0].revents & POLLIN) {
+      auto ret = read(session.output(), sink.data(), sink.size());
+      if (ret > 0) received += ret;
+    }
+  }
+  auto elapsed = (bench::NowNs() - start) / 1e9;
+
+  struct rusage usage;
+  if (!session.Stop(&usage)) return EXIT_FAILURE;
+  auto cpu = bench::CpuSeconds(usage);
+
+  printf("{\"bench\": \"rx_throughput\", \"stdout\": \"%s\", "
+         "\"options\": \"%s\", \"bytes\": %llu, \"received\": %llu, "
+         "\"seconds\": %.3f, \"bytes_per_sec\": %.0f, "
+         "\"cpu_seconds\": %.3f, \"cpu_ms_per_mb\": %.3f, "
+         "\"peak_rss_kb\": %llu}\n",
+         (flags & bench::PtySession::kPipeStdout) ? "pipe" : "pty",
+         bench::JoinOptions(options).c_str(), static_cast<unsigned long long>(size),
+         static_cast<unsigned long long>(received), elapsed,
+         received / elapsed, cpu, cpu * 1000 / (size / 1048576.0),
+         static_cast<unsigned long long>(bench::PeakRssKb(usage)));
+  return received == size ? EXIT_SUCCESS : EXIT_FAILURE;
+}
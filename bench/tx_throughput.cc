@@ -0,0 +1,132 @@
+/****************************************************************************
+ * bench/tx_throughput.cc
+ *
+ *   Measures how fast stermcom sends redirected or piped input to the
+ *   device, and its CPU time per MB and peak memory while doing so.
+ *
+ *   Copyright (c) 2026 Yoshinori Sugino
+ *   This software is released under the MIT License.
+ ****************************************************************************/
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "pty_harness.h"
+
+namespace {
+
+std::vector<uint8_t> makePattern() {
+  // Printable lines, like a command file
+  std::vector<uint8_t> pattern(64 * 1024);
+  for (size_t i = 0; i < pattern.size(); ++i)
+    pattern[i] = i % 64 == 63 ? '\n' : 'a' + i % 26;
+  return pattern;
+}
+
+bool writeInputFile(const std::string &path, uint64_t size) {
+  auto fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0600);
+  if (fd == -1) return false;
+  auto pattern = makePattern();
+  for (uint64_t written = 0; written < size;) {
+    auto len = std::min<uint64_t>(pattern.size(), size - written);
+    auto ret = write(fd, pattern.data(), len);
+    if (ret <= 0) break;
+    written += ret;
+  }
+  close(fd);
+  return true;
+}
+
+}  // namespace
+
+int main(int argc, char *argv[]) {
+  uint64_t size = 16 << 20;
+  bool use_pipe = false;
+
+  int opt_char;
+  while ((opt_char = getopt(argc, argv, "+m:p")) != -1) {
+    if (opt_char == 'm') {
+      size = std::strtoull(optarg, nullptr, 10) << 20;
+    } else if (opt_char == 'p') {
+      use_pipe = true;
+    } else {
+      return EXIT_FAILURE;
+    }
+  }
+  if (optind >= argc) {
+    printf("USAGE: %s [-m MiB] [-p] stermcom [options]\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  std::string input_path;
+  if (!use_pipe) {
+    char path[] = "/tmp/stermcom_bench_XXXXXX";
+    auto fd = mkstemp(path);
+    if (fd == -1) return EXIT_FAILURE;
+    close(fd);
+    input_path = path;
+    if (!writeInputFile(input_path, size)) return EXIT_FAILURE;
+  }
+
+  std::vector<std::string> options(argv + optind + 1, argv + argc);
+  bench::PtySession session(
+      argv[optind], options,
+      use_pipe ? bench::PtySession::kPipeStdin : 0, input_path);
+  auto is_ready = session.WaitReady(5000);
+  // stermcom has opened it by now
+  if (!input_path.empty()) unlink(input_path.c_str());
+  if (!is_ready) {
+    printf("stermcom did not start\n");
+    return EXIT_FAILURE;
+  }
+
+  auto pattern = makePattern();
+  std::vector<uint8_t> sink(64 * 1024);
+
+  uint64_t fed = 0, received = 0;
+  auto start    = bench::NowNs();
+  auto deadline = start + 60ull * 1000000000;
+
+  while (received < size && bench::NowNs() < deadline) {
+    auto is_feeding = use_pipe && fed < size;
+    struct pollfd pfds[2] = {
+      {session.device(), POLLIN, 0},
+      {is_feeding ? session.input() : -1, POLLOUT, 0},
+    };
+    if (poll(pfds, 2, 1000) <= 0) continue;
+
+    if (pfds[1].revents & POLLOUT) {
+      auto len = std::min<uint64_t>(pattern.size(), size - fed);
+      auto ret = write(session.input(), pattern.data(), len);
+      if (ret > 0) fed += ret;
+      if (fed == size) session.CloseInput();
+    }
+    if (pfds[0].revents & POLLIN) {
+      auto ret = read(session.device(), sink.data(), sink.size());
+      if (ret > 0) received += ret;
+    }
+  }
+  auto elapsed = (bench::NowNs() - start) / 1e9;
+
+  struct rusage usage;
+  if (!session.Stop(&usage)) return EXIT_FAILURE;
+  auto cpu = bench::CpuSeconds(usage);
+
+  printf("{\"bench\": \"tx_throughput\", \"stdin\": \"%s\", "
+         "\"options\": \"%s\", \"bytes\": %llu, \"sent\": %llu, "
+         "\"seconds\": %.3f, \"bytes_per_sec\": %.0f, "
+         "\"cpu_seconds\": %.3f, \"cpu_ms_per_mb\": %.3f, "
+         "\"peak_rss_kb\": %llu}\n",
+         use_pipe ? "pipe" : "file", bench::JoinOptions(options).c_str(),
+         static_cast<unsigned long long>(size),
+         static_cast<unsigned long long>(received), elapsed,
+         received / elapsed, cpu, cpu * 1000 / (size / 1048576.0),
+         static_cast<unsigned long long>(bench::PeakRssKb(usage)));
+  return received == size ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,133 @@
+/****************************************************************************
+ * byte_ring_buffer.cc
+ *
+ *   Copyright (c) 2026 Yoshinori Sugino
+ *   This software is released under the MIT License.
+ ****************************************************************************/
+#include "byte_ring_buffer.h"
+
+#include <sys/uio.h>
+
+#include <algorithm>
+#include <cstring>
+
+namespace util {
+
+ByteRingBuffer::ByteRingBuffer(size_t capacity)
+  : buffer_(std::max<size_t>(capacity, 1)),
+    head_(0),
+    size_(0) {
+}
+
+ByteRingBuffer::~ByteRingBuffer() {
+}
+
+size_t ByteRingBuffer::Capacity() const {
+  return buffer_.size();
+}
+
+size_t ByteRingBuffer::Size() const {
+  return size_;
+}
+
+size_t ByteRingBuffer::Free() const {
+  return buffer_.size() - size_;
+}
+
+bool ByteRingBuffer::Empty() const {
+  return size_ == 0;
+}
+
+uint8_t ByteRingBuffer::At(size_t index) const {
+  return buffer_[(head_ + index) % buffer_.size()];
+}
+
+size_t ByteRingBuffer::Find(uint8_t c, size_t max_size) const {
+  auto size  = std::min(size_, max_size);
+  auto first = std::min(size, buffer_.size() - head_);
+
+  auto found = std::memchr(&buffer_[head_], c, first);
+  if (found != nullptr)
+    return static_cast<const uint8_t *>(found) - &buffer_[head_];
+  if (size == first) return size;
+
+  found = std::memchr(&buffer_[0], c, size - first);
+  if (found != nullptr)
+    return first + (static_cast<const uint8_t *>(found) - &buffer_[0]);
+  return size;
+}
+
+size_t ByteRingBuffer::Peek(const uint8_t **data, size_t offset) const {
+  if (offset >= size_) return 0;
+
+  auto index = (head_ + offset) % buffer_.size();
+  *data = &buffer_[index];
+  return std::min(size_ - offset, buffer_.size() - index);
+}
+
+size_t ByteRingBuffer::Push(const uint8_t *data, size_t size) {
+  size = std::min(size, Free());
+  if (size == 0) return 0;
+
+  auto tail  = (head_ + size_) % buffer_.size();
+  auto first = std::min(size, buffer_.size() - tail);
+  std::memcpy(&buffer_[tail], data, first);
+  std::memcpy(&buffer_[0], data + first, size - first);
+  size_ += size;
+
+  return size;
+}
+
+bool ByteRingBuffer::PushBack(uint8_t c) {
+  return Push(&c, 1) == 1;
+}
+
+void ByteRingBuffer::Consume(size_t size) {
+  size = std::min(size, size_);
+  head_ = (head_ + size) % buffer_.size();
+  size_ -= size;
+  // Restart from the beginning to keep the data contiguous
+  if (size_ == 0) head_ = 0;
+}
+
+void ByteRingBuffer::Clear() {
+  head_ = 0;
+  size_ = 0;
+}
+
+ssize_t ByteRingBuffer::WriteTo(const int32_t &fd, size_t max_size) {
+  auto size = std::min(size_, max_size);
+  if (size == 0) return 0;
+
+  struct iovec iov[2];
+  auto first = std::min(size, buffer_.size() - head_);
+  iov[0].iov_base = &buffer_[head_];
+  iov[0].iov_len  = first;
+  iov[1].iov_base = &buffer_[0];
+  iov[1].iov_len  = size - first;
+
+  auto ret = writev(fd, iov, iov[1].iov_len == 0 ? 1 : 2);
+  if (ret > 0) Consume(ret);
+
+  return ret;
+}
+
+ssize_t ByteRingBuffer::ReadFrom(const int32_t &fd, size_t max_size) {
+  auto size = std::min(Free(), max_size);
+  if (size == 0) return 0;
+
+  struct iovec iov[2];
+  auto tail  = (head_ + size_) % buffer_.size();
+  auto first = std::min(size, buffer_.size() - tail);
+  iov[0].iov_base = &buffer_[tail];
+  iov[0].iov_len  = first;
+  iov[1].iov_base = &buffer_[0];
+  iov[1].iov_len  = size - first;
+
+  auto ret = readv(fd, iov, iov[1].iov_len == 0 ? 1 : 2);
+  if (ret > 0) size_ += ret;
+
+  return ret;
+}
+
+}  // namespace util
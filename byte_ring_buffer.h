@@ -0,0 +1,61 @@
+/****************************************************************************
+ * byte_ring_buffer.h
+ *
+ *   Copyright (c) 2026 Yoshinori Sugino
+ *   This software is released under the MIT License.
+ ****************************************************************************/
+#ifndef BYTE_RING_BUFFER_H_
+#define BYTE_RING_BUFFER_H_
+
+#include <sys/types.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace util {
+
+// Fixed-capacity FIFO of bytes. The storage is allocated once, and the
+// buffered bytes are moved to and from descriptors with one readv()/writev().
+class ByteRingBuffer final {
+ public:
+  ByteRingBuffer() = delete;
+  explicit ByteRingBuffer(size_t capacity);
+  ~ByteRingBuffer();
+
+  size_t Capacity() const;
+  size_t Size() const;
+  size_t Free() const;
+  bool Empty() const;
+  // Byte at index counted from the front (index must be less than Size())
+  uint8_t At(size_t index) const;
+  // Index of the first c among the first max_size bytes, or
+  // min(max_size, Size()) when there is none
+  size_t Find(uint8_t c, size_t max_size = SIZE_MAX) const;
+  // Contiguous region of buffered bytes starting offset bytes from the
+  // front. The data stays valid until the next Push().
+  size_t Peek(const uint8_t **data, size_t offset = 0) const;
+
+  // Appends as many bytes as fit and returns the number of appended bytes
+  size_t Push(const uint8_t *data, size_t size);
+  bool PushBack(uint8_t c);
+  // Drops size bytes from the front
+  void Consume(size_t size);
+  void Clear();
+
+  // Writes up to max_size buffered bytes and consumes what fd accepted.
+  // Returns the result of writev().
+  ssize_t WriteTo(const int32_t &fd, size_t max_size = SIZE_MAX);
+  // Reads up to max_size bytes into the free space.
+  // Returns the result of readv().
+  ssize_t ReadFrom(const int32_t &fd, size_t max_size = SIZE_MAX);
+
+ private:
+  std::vector<uint8_t> buffer_;
+  size_t head_;
+  size_t size_;
+};
+
+}  // namespace util
+
+#endif  // BYTE_RING_BUFFER_H_
@@ -0,0 +1,34 @@
+/****************************************************************************
+ * byte_view.h
+ *
+ *   Copyright (c) 2026 Yoshinori Sugino
+ *   This software is released under the MIT License.
+ ****************************************************************************/
+#ifndef BYTE_VIEW_H_
+#define BYTE_VIEW_H_
+
+#include <cstddef>
+#include <cstdint>
+
+namespace util {
+
+// Non-owning reference to contiguous bytes
+struct ByteView {
+  const uint8_t *data;
+  size_t size;
+
+  bool empty() const { return size == 0; }
+  const uint8_t *begin() const { return data; }
+  const uint8_t *end() const { return data + size; }
+};
+
+// A byte repeated count times (e.g. the DELs which erase a line), which
+// needs no storage however long it is
+struct ByteRun {
+  uint8_t byte;
+  size_t count;
+};
+
+}  // namespace util
+
+#endif  // BYTE_VIEW_H_
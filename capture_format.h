@@ -0,0 +1,44 @@
+/****************************************************************************
+ * capture_format.h
+ *
+ *   Copyright (c) 2026 Yoshinori Sugino
+ *   This software is released under the MIT License.
+ ****************************************************************************/
+#ifndef CAPTURE_FORMAT_H_
+#define CAPTURE_FORMAT_H_
+
+#include <cstdint>
+
+namespace util {
+
+// A capture file is a CaptureFileHeader followed by records. Each record
+// is a CaptureRecordHeader followed by size bytes of data. All integers
+// are in the byte order of the capturing host.
+
+constexpr const char kCaptureMagic[8] = {'S', 'T', 'C', 'A', 'P', 'T', '0', '1'};
+
+enum class capture_direction_t : uint8_t {
+  kReceived = 0,  // From the device
+  kSent     = 1   // To the device
+};
+
+struct CaptureFileHeader {
+  char magic[8];
+  // CLOCK_REALTIME at timestamp 0
+  uint64_t start_realtime_ns;
+};
+
+struct CaptureRecordHeader {
+  // CLOCK_MONOTONIC since the start of the capture
+  uint64_t timestamp_ns;
+  uint32_t size;
+  uint8_t direction;
+  uint8_t reserved[3];
+};
+
+static_assert(sizeof(CaptureFileHeader) == 16, "unexpected padding");
+static_assert(sizeof(CaptureRecordHeader) == 16, "unexpected padding");
+
+}  // namespace util
+
+#endif  // CAPTURE_FORMAT_H_
@@ -0,0 +1,129 @@
+/****************************************************************************
+ * capture_writer.cc
+ *
+ *   Copyright (c) 2026 Yoshinori Sugino
+ *   This software is released under the MIT License.
+ ****************************************************************************/
+#include "capture_writer.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+
+#include "debug.h"
+
+namespace util {
+
+namespace {
+
+constexpr const size_t kWindowSize = 8 * 1024 * 1024;
+
+uint64_t clockNs(clockid_t clock_id) {
+  struct timespec ts;
+  clock_gettime(clock_id, &ts);
+  return static_cast<uint64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+}  // namespace
+
+CaptureWriter::CaptureWriter(const std::string &path)
+  : path_(path),
+    fd_(-1),
+    page_size_(sysconf(_SC_PAGESIZE)),
+    window_(nullptr),
+    window_offset_(0),
+    window_size_(0),
+    end_(0),
+    start_ns_(0),
+    has_failed_(false) {
+}
+
+CaptureWriter::~CaptureWriter() {
+  Close();
+}
+
+common::status_t CaptureWriter::Open() {
+  fd_ = open(path_.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+  if (fd_ == -1) return common::status_t::kFailure;
+
+  CaptureFileHeader header{};
+  std::memcpy(header.magic, kCaptureMagic, sizeof(header.magic));
+  header.start_realtime_ns = clockNs(CLOCK_REALTIME);
+  start_ns_ = clockNs(CLOCK_MONOTONIC);
+
+  auto region = Reserve(sizeof(header));
+  if (region == nullptr) {
+    Close();
+    return common::status_t::kFailure;
+  }
+  std::memcpy(region, &header, sizeof(header));
+  return common::status_t::kSuccess;
+}
+
+void CaptureWriter::Record(capture_direction_t direction,
+                           const uint8_t *data, size_t size) {
+  if (fd_ == -1 || has_failed_ || size == 0) return;
+
+  CaptureRecordHeader header{};
+  header.timestamp_ns = clockNs(CLOCK_MONOTONIC) - start_ns_;
+  header.size         = size;
+  header.direction    = static_cast<uint8_t>(direction);
+
+  auto region = Reserve(sizeof(header) + size);
+  if (region == nullptr) return;
+  std::memcpy(region, &header, sizeof(header));
+  std::memcpy(region + sizeof(header), data, size);
+}
+
+void CaptureWriter::Close() {
+  if (fd_ == -1) return;
+
+  if (window_ != nullptr) munmap(window_, window_size_);
+  window_ = nullptr;
+  // Drop the space reserved beyond the records
+  if (ftruncate(fd_, end_) == -1) DEBUG_PRINTF("Fail to truncate the capture");
+  close(fd_);
+  fd_ = -1;
+}
+
+bool CaptureWriter::HasFailed() const {
+  return has_failed_;
+}
+
+uint8_t *CaptureWriter::Reserve(size_t size) {
+  if (window_ == nullptr || end_ + size > window_offset_ + window_size_) {
+    if (window_ != nullptr) munmap(window_, window_size_);
+    window_ = nullptr;
+
+    // The new window starts at the page holding end_
+    window_offset_ = end_ & ~static_cast<uint64_t>(page_size_ - 1);
+    auto needed    = end_ - window_offset_ + size;
+    window_size_   = std::max(kWindowSize,
+                              (needed + page_size_ - 1) & ~(page_size_ - 1));
+
+    // Allocated blocks, so that a full disk fails here and not with
+    // SIGBUS on a store to the mapping
+    if (posix_fallocate(fd_, window_offset_, window_size_) != 0) {
+      DEBUG_PRINTF("Fail to grow the capture, stop recording");
+      has_failed_ = true;
+      return nullptr;
+    }
+    auto window = mmap(nullptr, window_size_, PROT_READ | PROT_WRITE,
+                       MAP_SHARED, fd_, window_offset_);
+    if (window == MAP_FAILED) {
+      has_failed_ = true;
+      return nullptr;
+    }
+    window_ = static_cast<uint8_t *>(window);
+  }
+
+  auto region = window_ + (end_ - window_offset_);
+  end_ += size;
+  return region;
+}
+
+}  // namespace util
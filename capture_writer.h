@@ -0,0 +1,57 @@
+/****************************************************************************
+ * capture_writer.h
+ *
+ *   Copyright (c) 2026 Yoshinori Sugino
+ *   This software is released under the MIT License.
+ ****************************************************************************/
+#ifndef CAPTURE_WRITER_H_
+#define CAPTURE_WRITER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "capture_format.h"
+#include "common_type.h"
+
+namespace util {
+
+// Appends timestamped records to a capture file (see capture_format.h).
+// Records are copied into a memory-mapped window of the file, which is
+// moved forward and grown as the capture grows, so that recording costs
+// no system call per chunk.
+class CaptureWriter final {
+ public:
+  CaptureWriter() = delete;
+  explicit CaptureWriter(const std::string &path);
+  ~CaptureWriter();
+  CaptureWriter(const CaptureWriter &) = delete;
+  CaptureWriter &operator=(const CaptureWriter &) = delete;
+
+  common::status_t Open();
+  void Record(capture_direction_t direction, const uint8_t *data,
+              size_t size);
+  // Cuts the file to the recorded size
+  void Close();
+  // Recording stops when the file cannot be grown (e.g. the disk is full)
+  bool HasFailed() const;
+
+ private:
+  uint8_t *Reserve(size_t size);
+
+  std::string path_;
+  int32_t fd_;
+  size_t page_size_;
+  uint8_t *window_;
+  // File offset and size of the window
+  uint64_t window_offset_;
+  size_t window_size_;
+  // End of the recorded data in the file
+  uint64_t end_;
+  uint64_t start_ns_;
+  bool has_failed_;
+};
+
+}  // namespace util
+
+#endif  // CAPTURE_WRITER_H_
@@ -14,6 +14,7 @@ namespace common {
 enum class status_t : uint8_t {
   kSuccess,
   kFailure,
+  kTimeout,
   kUnknown
 };
 
@@ -0,0 +1,69 @@
+/****************************************************************************
+ * custom_baud_rate.cc
+ *
+ *   Copyright (c) 2026 Yoshinori Sugino
+ *   This software is released under the MIT License.
+ ****************************************************************************/
+#include "custom_baud_rate.h"
+
+// <asm/termbits.h> conflicts with <termios.h>, so this translation unit
+// must not include it (directly or through terminal_interface.h)
+#ifdef __linux__
+#include <asm/ioctls.h>
+#include <asm/termbits.h>
+#include <sys/ioctl.h>
+#endif  // __linux__
+
+#include <algorithm>
+#include <cstring>
+
+namespace util {
+
+constexpr const size_t TerminalSettings::kControlCharCount;
+
+common::status_t SetCustomBaudRate(const int32_t &fd,
+                                   const TerminalSettings &settings,
+                                   const uint32_t &output_rate,
+                                   const uint32_t &input_rate) {
+#if defined(__linux__) && defined(BOTHER)
+  // The control characters have the same indices in both structs
+  struct termios2 tio;
+  std::memset(&tio, 0, sizeof(tio));
+  tio.c_iflag = settings.input_flags;
+  tio.c_oflag = settings.output_flags;
+  tio.c_cflag = settings.control_flags;
+  tio.c_lflag = settings.local_flags;
+  tio.c_line  = settings.line;
+  std::memcpy(tio.c_cc, settings.control_chars,
+              std::min(sizeof(tio.c_cc), sizeof(settings.control_chars)));
+
+  tio.c_cflag &= ~(CBAUD | (CBAUD << IBSHIFT));
+  tio.c_cflag |= BOTHER | (BOTHER << IBSHIFT);
+  tio.c_ospeed = output_rate;
+  tio.c_ispeed = input_rate == 0 ? output_rate : input_rate;
+
+  if (ioctl(fd, TCSETS2, &tio)) return common::status_t::kFailure;
+  return common::status_t::kSuccess;
+#else
+  (void)fd;
+  (void)settings;
+  (void)output_rate;
+  (void)input_rate;
+  return common::status_t::kFailure;
+#endif  // defined(__linux__) && defined(BOTHER)
+}
+
+common::status_t GetBaudRate(const int32_t &fd, uint32_t *output_rate) {
+#if defined(__linux__) && defined(BOTHER)
+  struct termios2 tio;
+  if (ioctl(fd, TCGETS2, &tio)) return common::status_t::kFailure;
+  *output_rate = tio.c_ospeed;
+  return common::status_t::kSuccess;
+#else
+  (void)fd;
+  (void)output_rate;
+  return common::status_t::kFailure;
+#endif  // defined(__linux__) && defined(BOTHER)
+}
+
+}  // namespace util
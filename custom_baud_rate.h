@@ -0,0 +1,43 @@
+/****************************************************************************
+ * custom_baud_rate.h
+ *
+ *   Copyright (c) 2026 Yoshinori Sugino
+ *   This software is released under the MIT License.
+ ****************************************************************************/
+#ifndef CUSTOM_BAUD_RATE_H_
+#define CUSTOM_BAUD_RATE_H_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "common_type.h"
+
+namespace util {
+
+// The settings of a struct termios, which cannot be named together with
+// struct termios2
+struct TerminalSettings {
+  static constexpr const size_t kControlCharCount = 32;
+
+  uint32_t input_flags;
+  uint32_t output_flags;
+  uint32_t control_flags;
+  uint32_t local_flags;
+  uint8_t line;
+  uint8_t control_chars[kControlCharCount];
+};
+
+// Applies settings with any integer baud rate through termios2/BOTHER in
+// a single call (Linux only), so that the line never passes through
+// another rate. B0 on the way would drop DTR and RTS.
+// An input_rate of 0 makes the input rate follow the output rate.
+common::status_t SetCustomBaudRate(const int32_t &fd,
+                                   const TerminalSettings &settings,
+                                   const uint32_t &output_rate,
+                                   const uint32_t &input_rate);
+// Reads back the output rate which the driver actually applied
+common::status_t GetBaudRate(const int32_t &fd, uint32_t *output_rate);
+
+}  // namespace util
+
+#endif  // CUSTOM_BAUD_RATE_H_
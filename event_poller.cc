@@ -0,0 +1,196 @@
+/****************************************************************************
+ * event_poller.cc
+ *
+ *   Copyright (c) 2026 Yoshinori Sugino
+ *   This software is released under the MIT License.
+ ****************************************************************************/
+#include "event_poller.h"
+
+#ifdef __linux__
+#include <sys/epoll.h>
+#endif  // __linux__
+#include <sys/select.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+
+#include "debug.h"
+
+namespace util {
+
+constexpr uint32_t EventPoller::kReadable;
+constexpr uint32_t EventPoller::kWritable;
+constexpr uint32_t EventPoller::kError;
+constexpr uint32_t EventPoller::kMaxEvents;
+
+namespace {
+
+#ifdef __linux__
+uint32_t toEpollEvents(uint32_t events) {
+  uint32_t epoll_events = 0;
+  if (events & EventPoller::kReadable) epoll_events |= EPOLLIN;
+  if (events & EventPoller::kWritable) epoll_events |= EPOLLOUT;
+  return epoll_events;
+}
+
+uint32_t fromEpollEvents(uint32_t epoll_events) {
+  uint32_t events = 0;
+  if (epoll_events & EPOLLIN) events |= EventPoller::kReadable;
+  if (epoll_events & EPOLLOUT) events |= EventPoller::kWritable;
+  if (epoll_events & (EPOLLERR | EPOLLHUP)) events |= EventPoller::kError;
+  return events;
+}
+#endif  // __linux__
+
+}  // namespace
+
+EventPoller::EventPoller()
+  : epoll_fd_(-1),
+    interests_() {
+#ifdef __linux__
+  epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+  if (epoll_fd_ == -1) DEBUG_PRINTF("epoll is unavailable, use select");
+#endif  // __linux__
+}
+
+EventPoller::~EventPoller() {
+  if (epoll_fd_ != -1) close(epoll_fd_);
+}
+
+bool EventPoller::UsesEpoll() const {
+  return epoll_fd_ != -1;
+}
+
+common::status_t EventPoller::Add(const int32_t &fd, uint32_t events) {
+  if (fd < 0 || Find(fd) != interests_.end())
+    return common::status_t::kFailure;
+
+#ifdef __linux__
+  if (UsesEpoll()) {
+    struct epoll_event ev{};
+    ev.events  = toEpollEvents(events);
+    ev.data.fd = fd;
+    if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &ev) == -1)
+      return common::status_t::kFailure;
+  }
+#endif  // __linux__
+  if (!UsesEpoll() && fd >= FD_SETSIZE) return common::status_t::kFailure;
+
+  interests_.push_back({fd, events});
+  return common::status_t::kSuccess;
+}
+
+common::status_t EventPoller::Modify(const int32_t &fd, uint32_t events) {
+  auto itr = Find(fd);
+  if (itr == interests_.end()) return common::status_t::kFailure;
+  if (itr->events == events) return common::status_t::kSuccess;
+
+#ifdef __linux__
+  if (UsesEpoll()) {
+    struct epoll_event ev{};
+    ev.events  = toEpollEvents(events);
+    ev.data.fd = fd;
+    if (epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, fd, &ev) == -1)
+      return common::status_t::kFailure;
+  }
+#endif  // __linux__
+
+  itr->events = events;
+  return common::status_t::kSuccess;
+}
+
+common::status_t EventPoller::Remove(const int32_t &fd) {
+  auto itr = Find(fd);
+  if (itr == interests_.end()) return common::status_t::kFailure;
+
+#ifdef __linux__
+  if (UsesEpoll()) {
+    // The descriptor may already be closed, so the result is ignored
+    (void)epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, nullptr);
+  }
+#endif  // __linux__
+
+  interests_.erase(itr);
+  return common::status_t::kSuccess;
+}
+
+int32_t EventPoller::Wait(int32_t timeout_ms, PollEvent *events,
+                          uint32_t max_events) {
+  if (max_events == 0) return 0;
+  if (UsesEpoll()) return WaitEpoll(timeout_ms, events, max_events);
+  return WaitSelect(timeout_ms, events, max_events);
+}
+
+std::vector<EventPoller::Interest>::iterator EventPoller::Find(
+    const int32_t &fd) {
+  return std::find_if(interests_.begin(), interests_.end(),
+                      [&fd](const Interest &interest) -> bool {
+                        return interest.fd == fd;
+                      });
+}
+
+int32_t EventPoller::WaitEpoll(int32_t timeout_ms, PollEvent *events,
+                               uint32_t max_events) {
+#ifdef __linux__
+  struct epoll_event epoll_events[kMaxEvents];
+  max_events = std::min(max_events, kMaxEvents);
+
+  auto ret = epoll_wait(epoll_fd_, epoll_events, max_events,
+                        timeout_ms < 0 ? -1 : timeout_ms);
+  if (ret == -1) return -1;
+
+  for (int32_t i = 0; i < ret; ++i) {
+    events[i].fd     = epoll_events[i].data.fd;
+    events[i].events = fromEpollEvents(epoll_events[i].events);
+  }
+  return ret;
+#else
+  (void)timeout_ms;
+  (void)events;
+  (void)max_events;
+  errno = ENOSYS;
+  return -1;
+#endif  // __linux__
+}
+
+int32_t EventPoller::WaitSelect(int32_t timeout_ms, PollEvent *events,
+                                uint32_t max_events) {
+  fd_set fds_r, fds_w;
+  int32_t max_fd = -1;
+
+  FD_ZERO(&fds_r);
+  FD_ZERO(&fds_w);
+
+  for (const auto &interest : interests_) {
+    if (interest.events & kReadable) FD_SET(interest.fd, &fds_r);
+    if (interest.events & kWritable) FD_SET(interest.fd, &fds_w);
+    max_fd = std::max(max_fd, interest.fd);
+  }
+
+  struct timeval tv;
+  struct timeval *tv_ptr = nullptr;
+  if (timeout_ms >= 0) {
+    tv.tv_sec  = timeout_ms / 1000;
+    tv.tv_usec = (timeout_ms % 1000) * 1000;
+    tv_ptr = &tv;
+  }
+
+  auto ret = select(max_fd + 1, &fds_r, &fds_w, nullptr, tv_ptr);
+  if (ret == -1) return -1;
+
+  uint32_t count = 0;
+  for (const auto &interest : interests_) {
+    if (count == max_events) break;
+    uint32_t ready = 0;
+    if (FD_ISSET(interest.fd, &fds_r)) ready |= kReadable;
+    if (FD_ISSET(interest.fd, &fds_w)) ready |= kWritable;
+    if (ready == 0) continue;
+    events[count].fd     = interest.fd;
+    events[count].events = ready;
+    ++count;
+  }
+  return count;
+}
+
+}  // namespace util
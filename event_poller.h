@@ -0,0 +1,65 @@
+/****************************************************************************
+ * event_poller.h
+ *
+ *   Copyright (c) 2026 Yoshinori Sugino
+ *   This software is released under the MIT License.
+ ****************************************************************************/
+#ifndef EVENT_POLLER_H_
+#define EVENT_POLLER_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "common_type.h"
+
+namespace util {
+
+struct PollEvent {
+  int32_t fd;
+  uint32_t events;
+};
+
+// Waits for readiness on a small set of descriptors.
+// epoll(7) is used when available, otherwise select(2).
+class EventPoller final {
+ public:
+  static constexpr uint32_t kReadable = 0x1;
+  static constexpr uint32_t kWritable = 0x2;
+  // Hang-up or error condition (only reported, never requested)
+  static constexpr uint32_t kError    = 0x4;
+
+  static constexpr uint32_t kMaxEvents = 8;
+
+  EventPoller();
+  ~EventPoller();
+  EventPoller(const EventPoller &) = delete;
+  EventPoller &operator=(const EventPoller &) = delete;
+
+  bool UsesEpoll() const;
+  common::status_t Add(const int32_t &fd, uint32_t events);
+  // Does nothing when the interest of fd is unchanged
+  common::status_t Modify(const int32_t &fd, uint32_t events);
+  common::status_t Remove(const int32_t &fd);
+  // Returns the number of stored events, 0 on timeout or -1 on error.
+  // A negative timeout_ms waits indefinitely.
+  int32_t Wait(int32_t timeout_ms, PollEvent *events, uint32_t max_events);
+
+ private:
+  struct Interest {
+    int32_t fd;
+    uint32_t events;
+  };
+
+  std::vector<Interest>::iterator Find(const int32_t &fd);
+  int32_t WaitEpoll(int32_t timeout_ms, PollEvent *events,
+                    uint32_t max_events);
+  int32_t WaitSelect(int32_t timeout_ms, PollEvent *events,
+                     uint32_t max_events);
+
+  int32_t epoll_fd_;
+  std::vector<Interest> interests_;
+};
+
+}  // namespace util
+
+#endif  // EVENT_POLLER_H_
@@ -0,0 +1,105 @@
+/****************************************************************************
+ * expect_script.cc
+ *
+ *   Copyright (c) 2026 Yoshinori Sugino
+ *   This software is released under the MIT License.
+ ****************************************************************************/
+#include "expect_script.h"
+
+#include <time.h>
+
+#include <algorithm>
+
+namespace util {
+
+namespace {
+
+constexpr uint64_t kNsPerMs = 1000000;
+
+uint64_t nowNs() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return static_cast<uint64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+}  // namespace
+
+ExpectScript::ExpectScript(const std::string &prompt, uint64_t timeout_ns,
+                           size_t buffer_size)
+  : buffer_(buffer_size),
+    matcher_(prompt),
+    timeout_ns_(timeout_ns),
+    is_waiting_(false),
+    step_(0),
+    line_(),
+    started_ns_(0),
+    answered_ns_(0) {
+}
+
+ByteRingBuffer &ExpectScript::Buffer() {
+  return buffer_;
+}
+
+bool ExpectScript::Advance(ByteRingBuffer &out, bool is_input_exhausted) {
+  if (is_waiting_) return false;
+  if (buffer_.Empty()) return is_input_exhausted;
+
+  auto size = buffer_.Find('\n');
+  if (size < buffer_.Size()) {
+    ++size;
+  } else if (!is_input_exhausted && buffer_.Free() > 0) {
+    // The rest of the line has not been read yet
+    return false;
+  }
+  if (out.Free() < size) return false;
+
+  line_.clear();
+  for (size_t i = 0; i < size; ++i) {
+    auto c = buffer_.At(i);
+    (void)out.PushBack(c);
+    if (c != '\r' && c != '\n') line_.push_back(static_cast<char>(c));
+  }
+  buffer_.Consume(size);
+
+  ++step_;
+  is_waiting_ = true;
+  started_ns_ = nowNs();
+  matcher_.Reset();
+  return false;
+}
+
+bool ExpectScript::Feed(const uint8_t *data, size_t size) {
+  if (!is_waiting_ || matcher_.Feed(data, size) == 0) return false;
+
+  is_waiting_  = false;
+  answered_ns_ = nowNs();
+  return true;
+}
+
+int32_t ExpectScript::TimeoutMs() const {
+  if (!is_waiting_) return -1;
+
+  auto elapsed_ns = nowNs() - started_ns_;
+  if (elapsed_ns >= timeout_ns_) return 0;
+  return static_cast<int32_t>(
+      std::min<uint64_t>((timeout_ns_ - elapsed_ns + kNsPerMs - 1) / kNsPerMs,
+                         INT32_MAX));
+}
+
+bool ExpectScript::IsTimedOut() const {
+  return is_waiting_ && nowNs() - started_ns_ >= timeout_ns_;
+}
+
+uint32_t ExpectScript::Step() const {
+  return step_;
+}
+
+const std::string &ExpectScript::Line() const {
+  return line_;
+}
+
+uint64_t ExpectScript::ElapsedNs() const {
+  return (is_waiting_ ? nowNs() : answered_ns_) - started_ns_;
+}
+
+}  // namespace util
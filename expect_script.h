@@ -0,0 +1,59 @@
+/****************************************************************************
+ * expect_script.h
+ *
+ *   Copyright (c) 2026 Yoshinori Sugino
+ *   This software is released under the MIT License.
+ ****************************************************************************/
+#ifndef EXPECT_SCRIPT_H_
+#define EXPECT_SCRIPT_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "byte_ring_buffer.h"
+#include "stream_matcher.h"
+
+namespace util {
+
+// Sends a script line by line. Each line is sent after the device has
+// answered the previous one with the prompt.
+class ExpectScript final {
+ public:
+  ExpectScript() = delete;
+  ExpectScript(const std::string &prompt, uint64_t timeout_ns,
+               size_t buffer_size);
+
+  // The script is read into this buffer
+  ByteRingBuffer &Buffer();
+
+  // Moves the next line into out when the previous one was answered.
+  // Returns true when the whole script has been run.
+  bool Advance(ByteRingBuffer &out, bool is_input_exhausted);
+  // Scans received bytes for the prompt. Returns true when the current
+  // step has been answered.
+  bool Feed(const uint8_t *data, size_t size);
+
+  // Milliseconds until the current step times out (-1: not waiting)
+  int32_t TimeoutMs() const;
+  bool IsTimedOut() const;
+
+  // The current (or last answered) step
+  uint32_t Step() const;
+  const std::string &Line() const;
+  uint64_t ElapsedNs() const;
+
+ private:
+  ByteRingBuffer buffer_;
+  StreamMatcher matcher_;
+  uint64_t timeout_ns_;
+  bool is_waiting_;
+  uint32_t step_;
+  std::string line_;
+  uint64_t started_ns_;
+  uint64_t answered_ns_;
+};
+
+}  // namespace util
+
+#endif  // EXPECT_SCRIPT_H_
@@ -0,0 +1,45 @@
+/****************************************************************************
+ * file_lock.cc
+ *
+ *   Copyright (c) 2026 Yoshinori Sugino
+ *   This software is released under the MIT License.
+ ****************************************************************************/
+#include "file_lock.h"
+
+#include <fcntl.h>
+#include <sys/file.h>
+#include <unistd.h>
+
+#include <cerrno>
+
+namespace util {
+
+FileLock::FileLock(const std::string &path)
+  : path_(path),
+    fd_(-1) {
+}
+
+FileLock::~FileLock() {
+  if (fd_ != -1) close(fd_);
+}
+
+common::status_t FileLock::Lock(bool is_exclusive) {
+  if (fd_ == -1) {
+    fd_ = open(path_.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+    // Somebody else's lock file may only be readable
+    if (fd_ == -1) fd_ = open(path_.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd_ == -1) return common::status_t::kFailure;
+  }
+
+  int ret;
+  do {
+    ret = flock(fd_, is_exclusive ? LOCK_EX : LOCK_SH);
+  } while (ret == -1 && errno == EINTR);
+  return ret == 0 ? common::status_t::kSuccess : common::status_t::kFailure;
+}
+
+void FileLock::Unlock() {
+  if (fd_ != -1) (void)flock(fd_, LOCK_UN);
+}
+
+}  // namespace util
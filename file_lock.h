@@ -0,0 +1,39 @@
+/****************************************************************************
+ * file_lock.h
+ *
+ *   Copyright (c) 2026 Yoshinori Sugino
+ *   This software is released under the MIT License.
+ ****************************************************************************/
+#ifndef FILE_LOCK_H_
+#define FILE_LOCK_H_
+
+#include <cstdint>
+#include <string>
+
+#include "common_type.h"
+
+namespace util {
+
+// An advisory lock (flock) held on a file of its own, so that the files it
+// guards can be renamed while it is held. The lock file is created on the
+// first Lock().
+class FileLock final {
+ public:
+  FileLock() = delete;
+  explicit FileLock(const std::string &path);
+  ~FileLock();
+  FileLock(const FileLock &) = delete;
+  FileLock &operator=(const FileLock &) = delete;
+
+  // Waits for the lock; shared locks only exclude exclusive ones
+  common::status_t Lock(bool is_exclusive);
+  void Unlock();
+
+ private:
+  std::string path_;
+  int32_t fd_;
+};
+
+}  // namespace util
+
+#endif  // FILE_LOCK_H_
@@ -0,0 +1,160 @@
+/****************************************************************************
+ * fuzz/history_reader_fuzz.cc
+ *
+ *   Uses the input as a history file: walks it with util::HistoryReader
+ *   before and after the file has grown, then writes its lines again
+ *   through util::HistoryWriter, which rotates them, and checks the lines
+ *   and the matches of the reverse search against a plain split of the
+ *   input. The first byte is the number of lines to keep and whether they
+ *   are appended as one batch, the second one where the file is split.
+ *
+ *   Copyright (c) 2026 Yoshinori Sugino
+ *   This software is released under the MIT License.
+ ****************************************************************************/
+#include <unistd.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "history_reader.h"
+#include "history_writer.h"
+
+namespace {
+
+// Splits as std::getline does: a final line without a newline counts
+std::vector<std::string> splitLines(const uint8_t *data, size_t size) {
+  std::vector<std::string> lines;
+  size_t start = 0;
+  for (size_t i = 0; i < size; ++i) {
+    if (data[i] == '\n') {
+      lines.emplace_back(data + start, data + i);
+      start = i + 1;
+    }
+  }
+  if (start < size) lines.emplace_back(data + start, data + size);
+  return lines;
+}
+
+const std::string &historyPath() {
+  static const std::string path = []() {
+    char path_template[] = "/tmp/stermcom-fuzz-XXXXXX";
+    auto fd = mkstemp(path_template);
+    if (fd < 0) abort();
+    close(fd);
+    return std::string(path_template);
+  }();
+  return path;
+}
+
+void writeFile(const std::string &path, const uint8_t *data, size_t size) {
+  auto fp = std::fopen(path.c_str(), "wb");
+  if (fp == nullptr) abort();
+  if (size > 0 && std::fwrite(data, 1, size, fp) != size) abort();
+  if (std::fclose(fp) != 0) abort();
+}
+
+// Recalls every line from the newest to the oldest and back
+void checkHistory(util::HistoryReader *reader,
+                  const std::vector<std::string> &lines) {
+  reader->StartSearch();
+  if (!reader->At().empty()) abort();
+  for (size_t i = lines.size(); i > 0; --i) {
+    reader->Up();
+    auto line = reader->At();
+    if (std::string(line.begin(), line.end()) != lines[i - 1]) abort();
+    if (reader->ClearHistoryLine().count != lines[i - 1].size()) abort();
+  }
+  // Stays at the oldest line
+  reader->Up();
+  for (size_t i = 1; i < lines.size(); ++i) {
+    reader->Down();
+    auto line = reader->At();
+    if (std::string(line.begin(), line.end()) != lines[i]) abort();
+  }
+  reader->Down();
+  if (!reader->At().empty()) abort();
+  reader->EndSearch();
+}
+
+// Walks the matches of a part of a line from the newest to the oldest
+void checkReverseSearch(util::HistoryReader *reader,
+                        const std::vector<std::string> &lines) {
+  if (lines.empty()) return;
+  const auto &middle = lines[lines.size() / 2];
+  for (size_t query_size : {size_t{1}, size_t{4}}) {
+    if (middle.empty()) return;
+    auto query = middle.substr(middle.size() / 3, query_size);
+
+    reader->StartReverseSearch();
+    reader->AddSearchBytes(
+        {reinterpret_cast<const uint8_t *>(query.data()), query.size()});
+    std::string selected;
+    bool is_selected = false;
+    for (size_t i = lines.size(); i > 0; --i) {
+      const auto &line = lines[i - 1];
+      if (line.find(query) == std::string::npos) continue;
+      if (is_selected && line == selected) continue;
+      if (is_selected) reader->SearchOlder();
+      auto found = reader->At();
+      if (reader->IsSearchFailing()) abort();
+      if (std::string(found.begin(), found.end()) != line) abort();
+      selected = line;
+      is_selected = true;
+    }
+    reader->SearchOlder();
+    if (!reader->IsSearchFailing()) abort();
+    reader->RemoveSearchByte();
+    if (reader->IsSearchFailing()) abort();
+    reader->EndSearch();
+  }
+}
+
+}  // namespace
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+  if (size < 2) return 0;
+
+  size_t keep = data[0] % 16 + 1;
+  auto sync_policy = (data[0] & 0x10) ? util::history_sync_t::kOnExit
+                                      : util::history_sync_t::kEveryLine;
+  // The rest of the input is written in two parts, so that the second
+  // search sees an appended file
+  size_t first_size = data[1] % (size - 1);
+  data += 2;
+  size -= 2;
+
+  const auto &path = historyPath();
+  (void)unlink((path + ".1").c_str());
+  util::HistoryReader reader(path, SIZE_MAX);
+  writeFile(path, data, first_size);
+  checkHistory(&reader, splitLines(data, first_size));
+  checkReverseSearch(&reader, splitLines(data, first_size));
+
+  writeFile(path, data, size);
+  auto lines = splitLines(data, size);
+  checkHistory(&reader, lines);
+  checkReverseSearch(&reader, lines);
+
+  // Empty lines are not recorded
+  (void)unlink(path.c_str());
+  util::HistoryWriter writer(path, keep, sync_policy);
+  std::vector<std::string> written;
+  for (const auto &line : lines) {
+    if (line.empty()) continue;
+    writer.AddStr(
+        {reinterpret_cast<const uint8_t *>(line.data()), line.size()});
+    if (writer.Write() != common::status_t::kSuccess) abort();
+    written.push_back(line);
+  }
+  if (writer.Flush() != common::status_t::kSuccess) abort();
+  if (written.size() > keep)
+    written.erase(written.begin(), written.end() - keep);
+  util::HistoryReader new_reader(path, keep);
+  checkHistory(&new_reader, written);
+  checkReverseSearch(&new_reader, written);
+  return 0;
+}
@@ -0,0 +1,64 @@
+/****************************************************************************
+ * fuzz/key_decoder_fuzz.cc
+ *
+ *   Feeds the input to util::KeyDecoder at once and split into chunks,
+ *   and checks that no byte is lost or reordered and that both ways
+ *   decode the same keys.
+ *
+ *   Copyright (c) 2026 Yoshinori Sugino
+ *   This software is released under the MIT License.
+ ****************************************************************************/
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+
+#include "read_key.h"
+
+namespace {
+
+struct Decoded {
+  std::vector<uint8_t> bytes;
+  // Keys other than the runs of plain and pasted bytes, which may be split
+  // at different places
+  std::vector<util::key_t> keys;
+};
+
+void append(const std::vector<util::KeyEvent> &events, Decoded *decoded) {
+  for (const auto &event : events) {
+    if (event.bytes.empty()) abort();
+    decoded->bytes.insert(decoded->bytes.end(), event.bytes.begin(),
+                          event.bytes.end());
+    if (event.key_type != util::key_t::kOther &&
+        event.key_type != util::key_t::kPaste)
+      decoded->keys.push_back(event.key_type);
+  }
+}
+
+Decoded decode(const uint8_t *data, size_t size, size_t chunk_size) {
+  util::KeyDecoder decoder;
+  Decoded decoded;
+  for (size_t i = 0; i < size; i += chunk_size) {
+    auto n = size - i < chunk_size ? size - i : chunk_size;
+    append(decoder.Feed(data + i, n), &decoded);
+  }
+  append(decoder.Flush(), &decoded);
+  if (decoder.HasPending()) abort();
+  return decoded;
+}
+
+}  // namespace
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+  if (size == 0) return 0;
+
+  auto whole = decode(data, size, size);
+  if (whole.bytes != std::vector<uint8_t>(data, data + size)) abort();
+
+  // The first byte chooses the chunk size, so the fuzzer can reach
+  // sequences split at every position
+  auto chunked = decode(data, size, data[0] % 8 + 1);
+  if (chunked.bytes != whole.bytes) abort();
+  if (chunked.keys != whole.keys) abort();
+  return 0;
+}
@@ -0,0 +1,94 @@
+/****************************************************************************
+ * fuzz/standalone_main.cc
+ *
+ *   Runs a fuzz target without libFuzzer: each argument is a file or a
+ *   directory of files to be passed to LLVMFuzzerTestOneInput. Without
+ *   arguments stdin is the only input, as AFL expects.
+ *
+ *   Copyright (c) 2026 Yoshinori Sugino
+ *   This software is released under the MIT License.
+ ****************************************************************************/
+#include <dirent.h>
+#include <sys/stat.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size);
+
+namespace {
+
+bool readAll(FILE *fp, std::vector<uint8_t> *data) {
+  uint8_t buffer[4096];
+  size_t n;
+  while ((n = std::fread(buffer, 1, sizeof(buffer), fp)) > 0) {
+    data->insert(data->end(), buffer, buffer + n);
+  }
+  return std::ferror(fp) == 0;
+}
+
+bool runFile(const std::string &path) {
+  auto fp = std::fopen(path.c_str(), "rb");
+  if (fp == nullptr) {
+    std::fprintf(stderr, "cannot open %s\n", path.c_str());
+    return false;
+  }
+  std::vector<uint8_t> data;
+  auto is_read = readAll(fp, &data);
+  std::fclose(fp);
+  if (!is_read) return false;
+
+  LLVMFuzzerTestOneInput(data.data(), data.size());
+  return true;
+}
+
+// Returns the number of inputs run, or -1 on error
+int64_t runPath(const std::string &path) {
+  struct stat buf;
+  if (stat(path.c_str(), &buf) != 0) {
+    std::fprintf(stderr, "cannot stat %s\n", path.c_str());
+    return -1;
+  }
+  if (!S_ISDIR(buf.st_mode)) return runFile(path) ? 1 : -1;
+
+  auto dir = opendir(path.c_str());
+  if (dir == nullptr) return -1;
+  int64_t count = 0;
+  struct dirent *entry;
+  while ((entry = readdir(dir)) != nullptr) {
+    std::string name(entry->d_name);
+    if (name == "." || name == "..") continue;
+    auto n = runPath(path + "/" + name);
+    if (n < 0) {
+      count = -1;
+      break;
+    }
+    count += n;
+  }
+  closedir(dir);
+  return count;
+}
+
+}  // namespace
+
+int main(int argc, char *argv[]) {
+  if (argc < 2) {
+    std::vector<uint8_t> data;
+    if (!readAll(stdin, &data)) return EXIT_FAILURE;
+    LLVMFuzzerTestOneInput(data.data(), data.size());
+    return EXIT_SUCCESS;
+  }
+
+  int64_t count = 0;
+  for (int i = 1; i < argc; ++i) {
+    auto n = runPath(argv[i]);
+    if (n < 0) return EXIT_FAILURE;
+    count += n;
+  }
+  std::fprintf(stderr, "%s: %lld inputs ok\n", argv[0],
+               static_cast<long long>(count));
+  return EXIT_SUCCESS;
+}
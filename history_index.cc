@@ -0,0 +1,185 @@
+/****************************************************************************
+ * history_index.cc
+ *
+ *   Copyright (c) 2026 Yoshinori Sugino
+ *   This software is released under the MIT License.
+ ****************************************************************************/
+#include "history_index.h"
+
+#include <algorithm>
+
+namespace util {
+
+namespace {
+
+uint64_t occurrence(uint32_t line, size_t offset) {
+  return (static_cast<uint64_t>(line) << 32) | offset;
+}
+
+uint32_t lineOf(uint64_t occurrence) {
+  return static_cast<uint32_t>(occurrence >> 32);
+}
+
+// lower_bound which probes from first in growing steps, so a walk through
+// a long list to close values costs little
+template <typename Iterator>
+Iterator gallop(Iterator first, Iterator last, uint64_t value) {
+  size_t step = 1;
+  while (static_cast<size_t>(last - first) > step && first[step] < value) {
+    first += step;
+    step *= 2;
+  }
+  auto end = static_cast<size_t>(last - first) > step ? first + step + 1
+                                                      : last;
+  return std::lower_bound(first, end, value);
+}
+
+}  // namespace
+
+constexpr const size_t HistoryIndex::kNotFound;
+
+HistoryIndex::HistoryIndex()
+  : lines_by_byte_(),
+    pairs_(),
+    size_(0),
+    query_(),
+    narrowed_() {
+}
+
+HistoryIndex::~HistoryIndex() {
+}
+
+void HistoryIndex::Add(const ByteView &line) {
+  auto number = static_cast<uint32_t>(size_++);
+  for (size_t i = 0; i < line.size; ++i) {
+    auto &lines = lines_by_byte_[line.data[i]];
+    if (lines.empty() || lines.back() != number) lines.push_back(number);
+    if (i + 1 < line.size) {
+      pairs_[Key(line.data[i], line.data[i + 1])].push_back(
+          occurrence(number, i));
+    }
+  }
+}
+
+void HistoryIndex::Truncate(size_t count) {
+  ClearQuery();
+  if (count >= size_) return;
+
+  for (auto &lines : lines_by_byte_) {
+    while (!lines.empty() && lines.back() >= count) lines.pop_back();
+  }
+  if (count == 0) {
+    pairs_.clear();
+  } else {
+    for (auto &entry : pairs_) {
+      auto &occurrences = entry.second;
+      while (!occurrences.empty() && lineOf(occurrences.back()) >= count)
+        occurrences.pop_back();
+    }
+  }
+  size_ = count;
+}
+
+size_t HistoryIndex::Size() const {
+  return size_;
+}
+
+void HistoryIndex::ClearQuery() {
+  query_.clear();
+}
+
+void HistoryIndex::PushQueryByte(uint8_t c) {
+  // Resized before the previous list is referred to
+  if (query_.size() >= 2 && narrowed_.size() < query_.size() - 1)
+    narrowed_.resize(query_.size() - 1);
+  auto previous = QueryOccurrences();
+  query_.push_back(c);
+  if (query_.size() < 3) return;
+
+  // An occurrence of the query goes on with its last pair of bytes
+  auto shift = query_.size() - 2;
+  auto pair = Pair(query_[shift], c);
+  auto &occurrences = narrowed_[query_.size() - 3];
+  occurrences.clear();
+  if (previous != nullptr && pair != nullptr) {
+    occurrences.reserve(std::min(previous->size(), pair->size()));
+    // Lists of a like size are merged, otherwise the shorter one is walked
+    // and the longer one searched
+    if (previous->size() / 8 <= pair->size() &&
+        pair->size() / 8 <= previous->size()) {
+      auto it = pair->begin();
+      for (auto start : *previous) {
+        while (it != pair->end() && *it < start + shift) ++it;
+        if (it == pair->end()) break;
+        if (*it == start + shift) occurrences.push_back(start);
+      }
+    } else if (previous->size() < pair->size()) {
+      auto it = pair->begin();
+      for (auto start : *previous) {
+        it = gallop(it, pair->end(), start + shift);
+        if (it == pair->end()) break;
+        if (*it == start + shift) occurrences.push_back(start);
+      }
+    } else {
+      auto it = previous->begin();
+      for (auto next : *pair) {
+        // The query would start before the line
+        if (static_cast<uint32_t>(next) < shift) continue;
+        it = gallop(it, previous->end(), next - shift);
+        if (it == previous->end()) break;
+        if (*it == next - shift) occurrences.push_back(next - shift);
+      }
+    }
+  }
+}
+
+void HistoryIndex::PopQueryByte() {
+  if (query_.empty()) return;
+  query_.pop_back();
+}
+
+size_t HistoryIndex::QuerySize() const {
+  return query_.size();
+}
+
+size_t HistoryIndex::Find(size_t first, size_t last) const {
+  if (size_ == 0) return kNotFound;
+  last = std::min(last, size_ - 1);
+  if (first > last) return kNotFound;
+
+  size_t found;
+  if (query_.empty()) {
+    found = last;
+  } else if (query_.size() == 1) {
+    const auto &lines = lines_by_byte_[query_[0]];
+    auto it = std::upper_bound(lines.begin(), lines.end(), last);
+    if (it == lines.begin()) return kNotFound;
+    found = *--it;
+  } else {
+    auto occurrences = QueryOccurrences();
+    if (occurrences == nullptr) return kNotFound;
+    auto it = std::upper_bound(occurrences->begin(), occurrences->end(),
+                               occurrence(last, UINT32_MAX));
+    if (it == occurrences->begin()) return kNotFound;
+    found = lineOf(*--it);
+  }
+  return found >= first ? found : kNotFound;
+}
+
+uint16_t HistoryIndex::Key(uint8_t first, uint8_t second) {
+  return static_cast<uint16_t>((first << 8) | second);
+}
+
+const HistoryIndex::Occurrences *HistoryIndex::Pair(uint8_t first,
+                                                    uint8_t second) const {
+  auto it = pairs_.find(Key(first, second));
+  return it == pairs_.end() ? nullptr : &it->second;
+}
+
+const HistoryIndex::Occurrences *HistoryIndex::QueryOccurrences() const {
+  if (query_.size() < 2) return nullptr;
+  if (query_.size() == 2) return Pair(query_[0], query_[1]);
+  return &narrowed_[query_.size() - 3];
+}
+
+}  // namespace util
@@ -0,0 +1,70 @@
+/****************************************************************************
+ * history_index.h
+ *
+ *   Copyright (c) 2026 Yoshinori Sugino
+ *   This software is released under the MIT License.
+ ****************************************************************************/
+#ifndef HISTORY_INDEX_H_
+#define HISTORY_INDEX_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "byte_view.h"
+
+namespace util {
+
+// An index of the history lines for the reverse search. Each pair of bytes
+// maps to where it occurs, so the occurrences of a query are narrowed one
+// typed byte at a time to those which go on with the next pair, and no
+// line has to be compared. Lines of a single byte query are listed per
+// byte.
+class HistoryIndex final {
+ public:
+  static constexpr const size_t kNotFound = SIZE_MAX;
+
+  HistoryIndex();
+  ~HistoryIndex();
+  HistoryIndex(const HistoryIndex &) = delete;
+  HistoryIndex &operator=(const HistoryIndex &) = delete;
+
+  // Lines are numbered in the order they are added
+  void Add(const ByteView &line);
+  // Drops the lines from count on, and the query
+  void Truncate(size_t count);
+  size_t Size() const;
+
+  void ClearQuery();
+  void PushQueryByte(uint8_t c);
+  void PopQueryByte();
+  size_t QuerySize() const;
+  // Returns the newest line from last down to first which contains the
+  // query
+  size_t Find(size_t first, size_t last) const;
+
+ private:
+  // Where a pair of bytes or a query starts: the line in the upper half
+  // and the offset in the line in the lower half, so occurrences are
+  // ordered as integers
+  using Occurrence = uint64_t;
+  using Occurrences = std::vector<Occurrence>;
+
+  static uint16_t Key(uint8_t first, uint8_t second);
+  const Occurrences *Pair(uint8_t first, uint8_t second) const;
+  // Occurrences of the query, from two bytes on
+  const Occurrences *QueryOccurrences() const;
+
+  std::vector<uint32_t> lines_by_byte_[256];
+  std::unordered_map<uint16_t, Occurrences> pairs_;
+  size_t size_;
+  std::vector<uint8_t> query_;
+  // Occurrences of the query narrowed by each byte from the third on. The
+  // lists are kept for the later queries, so that a key does not allocate.
+  std::vector<Occurrences> narrowed_;
+};
+
+}  // namespace util
+
+#endif  // HISTORY_INDEX_H_
@@ -6,7 +6,9 @@
  ****************************************************************************/
 #include "history_reader.h"
 
-#include <fstream>
+#include <algorithm>
+
+#include "debug.h"
 
 namespace util {
 
@@ -16,12 +18,24 @@ constexpr const uint8_t kKeycodeDel = 0x7f;
 
 }  // namespace
 
-HistoryReader::HistoryReader(const std::string &path)
-  : path_to_history_(path),
+HistoryReader::HistoryReader(const std::string &path, size_t max_lines)
+  : previous_store_(path + ".1"),
+    current_store_(path),
+    lock_(path + ".lock"),
+    max_lines_(max_lines),
     is_searching_(false),
     pre_str_size_(0),
-    history_list_(),
-    history_list_itr_() {
+    line_count_(0),
+    skipped_lines_(0),
+    position_(0),
+    index_(),
+    indexed_previous_generation_(0),
+    indexed_current_generation_(0),
+    indexed_previous_lines_(0),
+    indexed_current_lines_(0),
+    is_reverse_searching_(false),
+    is_search_failing_(false),
+    search_steps_() {
 }
 
 HistoryReader::~HistoryReader() {
@@ -30,75 +44,176 @@ HistoryReader::~HistoryReader() {
 void HistoryReader::StartSearch() {
   if (!is_searching_) {
     is_searching_ = true;
-    (void)ReadHistoryFile();
-    history_list_itr_ = history_list_.end();
+    // Both generations are read in step with the writers, which may rotate
+    // them. Only what has changed since the last search is read.
+    auto is_locked = lock_.Lock(false) == common::status_t::kSuccess;
+    if (previous_store_.Refresh() == common::status_t::kFailure ||
+        current_store_.Refresh() == common::status_t::kFailure)
+      DEBUG_PRINTF("Fail to read the history file");
+    if (is_locked) lock_.Unlock();
+
+    auto total = previous_store_.LineCount() + current_store_.LineCount();
+    line_count_    = std::min(total, max_lines_);
+    skipped_lines_ = total - line_count_;
+    position_      = line_count_;
   }
 }
 
 void HistoryReader::Up() {
   if (!is_searching_) return;
+  is_reverse_searching_ = false;
+  if (line_count_ == 0) return;
 
-  if (history_list_itr_ != history_list_.begin()) --history_list_itr_;
+  if (position_ > 0) --position_;
 
-  pre_str_size_ = (*history_list_itr_).size();
+  pre_str_size_ = Line(position_).size;
 }
 
 void HistoryReader::Down() {
   if (!is_searching_) return;
+  is_reverse_searching_ = false;
 
-  if (history_list_itr_ != history_list_.end()) ++history_list_itr_;
+  if (position_ < line_count_) ++position_;
 
-  if (history_list_itr_ != history_list_.end()) {
-    pre_str_size_ = (*history_list_itr_).size();
-  } else {
-    pre_str_size_ = 0;
-  }
+  pre_str_size_ = Line(position_).size;
 }
 
-std::list<uint8_t> HistoryReader::At() {
-  std::list<uint8_t> char_list{};
-
-  if (!is_searching_) return char_list;
-  if (history_list_itr_ == history_list_.end()) return char_list;
+ByteView HistoryReader::At() {
+  if (!is_searching_) return {nullptr, 0};
 
-  for (const auto &c : *history_list_itr_) {
-    char_list.push_back(c);
-  }
-
-  return char_list;
+  return Line(position_);
 }
 
 void HistoryReader::EndSearch() {
   if (!is_searching_) return;
 
-  history_list_.clear();
   pre_str_size_ = 0;
   is_searching_ = false;
+  is_reverse_searching_ = false;
+}
+
+ByteRun HistoryReader::ClearHistoryLine() const {
+  if (!is_searching_) return {kKeycodeDel, 0};
+
+  return {kKeycodeDel, pre_str_size_};
+}
+
+void HistoryReader::StartReverseSearch() {
+  StartSearch();
+  UpdateIndex();
+
+  is_reverse_searching_ = true;
+  is_search_failing_    = false;
+  index_.ClearQuery();
+  search_steps_.clear();
+}
+
+bool HistoryReader::IsReverseSearching() const {
+  return is_reverse_searching_;
+}
+
+void HistoryReader::AddSearchBytes(const ByteView &bytes) {
+  if (!is_reverse_searching_) return;
+
+  search_steps_.push_back(
+      {index_.QuerySize(), position_, is_search_failing_});
+  for (auto c : bytes) index_.PushQueryByte(c);
+  // No line has the shorter query, so none has this one
+  if (is_search_failing_) return;
+
+  // The selected line may still match
+  if (line_count_ == 0) {
+    is_search_failing_ = true;
+  } else {
+    SearchFrom(std::min(position_, line_count_ - 1), false);
+  }
 }
 
-std::list<uint8_t> HistoryReader::ClearHistoryLine() {
-  std::list<uint8_t> char_list{};
+void HistoryReader::RemoveSearchByte() {
+  if (!is_reverse_searching_ || search_steps_.empty()) return;
 
-  if (!is_searching_) return char_list;
+  const auto &step = search_steps_.back();
+  while (index_.QuerySize() > step.query_size) index_.PopQueryByte();
+  position_          = step.position;
+  is_search_failing_ = step.is_failing;
+  pre_str_size_      = Line(position_).size;
+  search_steps_.pop_back();
+}
+
+void HistoryReader::SearchOlder() {
+  if (!is_reverse_searching_ || index_.QuerySize() == 0) return;
 
-  for (int32_t i = 0; i < pre_str_size_; ++i) {
-    char_list.push_back(kKeycodeDel);
+  search_steps_.push_back(
+      {index_.QuerySize(), position_, is_search_failing_});
+  if (is_search_failing_) return;
+
+  if (position_ == 0) {
+    is_search_failing_ = true;
+  } else {
+    SearchFrom(position_ - 1, true);
   }
+}
 
-  return char_list;
+bool HistoryReader::IsSearchFailing() const {
+  return is_reverse_searching_ && is_search_failing_;
 }
 
-common::status_t HistoryReader::ReadHistoryFile() {
-  std::ifstream ifs(path_to_history_, std::ios::in);
-  std::string str;
+ByteView HistoryReader::Line(size_t index) const {
+  if (index >= line_count_) return {nullptr, 0};
+
+  return StoredLine(index + skipped_lines_);
+}
 
-  if (!ifs.is_open()) return common::status_t::kFailure;
+ByteView HistoryReader::StoredLine(size_t index) const {
+  auto previous_count = previous_store_.LineCount();
+  if (index < previous_count) return previous_store_.Line(index);
+  return current_store_.Line(index - previous_count);
+}
 
-  while (std::getline(ifs, str)) {
-    history_list_.push_back(str);
+void HistoryReader::UpdateIndex() {
+  // Lines appended to the current generation are added to the index, while
+  // a rotation changes the numbers of all lines
+  size_t kept_lines = 0;
+  auto previous_count = previous_store_.LineCount();
+  if (previous_store_.Generation() == indexed_previous_generation_ &&
+      previous_count == indexed_previous_lines_) {
+    kept_lines = previous_count;
+    // A line without its newline may have been completed since
+    if (current_store_.Generation() == indexed_current_generation_)
+      kept_lines += std::min(indexed_current_lines_,
+                             current_store_.CompleteLineCount());
   }
+  index_.Truncate(kept_lines);
 
-  return common::status_t::kSuccess;
+  auto total = previous_count + current_store_.LineCount();
+  DEBUG_PRINTF("Index the lines from %zu to %zu", index_.Size(), total);
+  for (auto i = index_.Size(); i < total; ++i) index_.Add(StoredLine(i));
+
+  indexed_previous_generation_ = previous_store_.Generation();
+  indexed_current_generation_  = current_store_.Generation();
+  indexed_previous_lines_      = previous_count;
+  indexed_current_lines_       = current_store_.CompleteLineCount();
+}
+
+void HistoryReader::SearchFrom(size_t position, bool is_other_text) {
+  auto selected = Line(position_);
+  for (;;) {
+    auto found = index_.Find(skipped_lines_, position + skipped_lines_);
+    if (found == HistoryIndex::kNotFound) break;
+
+    found -= skipped_lines_;
+    auto line = Line(found);
+    if (!is_other_text || line.size != selected.size ||
+        !std::equal(line.begin(), line.end(), selected.begin())) {
+      position_     = found;
+      pre_str_size_ = line.size;
+      return;
+    }
+    // Repeats of the selected command are skipped
+    if (found == 0) break;
+    position = found - 1;
+  }
+  is_search_failing_ = true;
 }
 
 }  // namespace util
@@ -7,35 +7,86 @@
 #ifndef HISTORY_READER_H_
 #define HISTORY_READER_H_
 
+#include <cstddef>
 #include <cstdint>
-#include <list>
 #include <string>
+#include <vector>
 
+#include "byte_view.h"
 #include "common_type.h"
+#include "file_lock.h"
+#include "history_index.h"
+#include "history_store.h"
 
 namespace util {
 
+// Recalls the newest max_lines lines of the two generations of the
+// history which HistoryWriter keeps, one by one with Up() and Down() or by
+// the reverse search
 class HistoryReader final {
  public:
   HistoryReader() = delete;
-  explicit HistoryReader(const std::string &path);
+  HistoryReader(const std::string &path, size_t max_lines);
   ~HistoryReader();
 
   void StartSearch();
   void Up();
   void Down();
-  std::list<uint8_t> At();
+  // The selected line, valid until the next StartSearch()
+  ByteView At();
   void EndSearch();
-  std::list<uint8_t> ClearHistoryLine();
+  // The DELs which erase the line shown by the last move
+  ByteRun ClearHistoryLine() const;
+
+  // The reverse search selects the newest line which contains the bytes
+  // typed so far. Up() and Down() move on from the selected line.
+  void StartReverseSearch();
+  bool IsReverseSearching() const;
+  void AddSearchBytes(const ByteView &bytes);
+  // Undoes the last AddSearchBytes() or SearchOlder()
+  void RemoveSearchByte();
+  // Selects the next older line with another text
+  void SearchOlder();
+  // True when no line contains the bytes typed so far
+  bool IsSearchFailing() const;
 
  private:
-  common::status_t ReadHistoryFile();
+  struct SearchStep {
+    size_t query_size;
+    size_t position;
+    bool is_failing;
+  };
+
+  ByteView Line(size_t index) const;
+  // Index across both generations, including the skipped lines
+  ByteView StoredLine(size_t index) const;
+  void UpdateIndex();
+  // Selects the newest line from position_ on, which is another text than
+  // the one selected when is_other_text is set
+  void SearchFrom(size_t position, bool is_other_text);
 
-  std::string path_to_history_;
+  HistoryStore previous_store_;
+  HistoryStore current_store_;
+  FileLock lock_;
+  size_t max_lines_;
   bool is_searching_;
   uint32_t pre_str_size_;
-  std::list<std::string> history_list_;
-  std::list<std::string>::iterator history_list_itr_;
+  // Lines of the history when the search started
+  size_t line_count_;
+  // Lines of the previous generation which are older than max_lines_
+  size_t skipped_lines_;
+  // Index of the selected line; line_count_ is the empty line below them
+  size_t position_;
+
+  HistoryIndex index_;
+  // The stores as they were when index_ was brought up to date
+  uint64_t indexed_previous_generation_;
+  uint64_t indexed_current_generation_;
+  size_t indexed_previous_lines_;
+  size_t indexed_current_lines_;
+  bool is_reverse_searching_;
+  bool is_search_failing_;
+  std::vector<SearchStep> search_steps_;
 };
 
 }  // namespace util
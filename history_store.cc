@@ -0,0 +1,151 @@
+/****************************************************************************
+ * history_store.cc
+ *
+ *   Copyright (c) 2026 Yoshinori Sugino
+ *   This software is released under the MIT License.
+ ****************************************************************************/
+#include "history_store.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#include "debug.h"
+
+namespace util {
+
+constexpr const size_t HistoryStore::kTailSize;
+
+HistoryStore::HistoryStore(const std::string &path)
+  : path_(path),
+    contents_(),
+    device_(0),
+    inode_(0),
+    mtime_(),
+    line_ends_(),
+    generation_(0) {
+}
+
+HistoryStore::~HistoryStore() {
+}
+
+common::status_t HistoryStore::Refresh() {
+  auto fd = open(path_.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd == -1) {
+    auto is_missing = errno == ENOENT;
+    ClearIndex();
+    contents_.clear();
+    return is_missing ? common::status_t::kSuccess
+                      : common::status_t::kFailure;
+  }
+  struct stat buf;
+  if (fstat(fd, &buf) == -1) {
+    close(fd);
+    return common::status_t::kFailure;
+  }
+
+  auto size = static_cast<size_t>(buf.st_size);
+  auto is_same_file = !contents_.empty() && buf.st_dev == device_ &&
+                      buf.st_ino == inode_;
+  // The mtime may be too coarse to tell two writes apart, so the tail of
+  // the file is compared as well
+  if (is_same_file && size == contents_.size() &&
+      buf.st_mtim.tv_sec == mtime_.tv_sec &&
+      buf.st_mtim.tv_nsec == mtime_.tv_nsec && IsAppendedTo(fd, size)) {
+    close(fd);
+    return common::status_t::kSuccess;
+  }
+
+  // Lines written by other sessions are appended. Anything else (e.g. the
+  // file was trimmed) is read and indexed from the start.
+  size_t offset = 0;
+  if (is_same_file && size > contents_.size() && IsAppendedTo(fd, size)) {
+    // A line without its newline yet may have been completed
+    offset = line_ends_.empty() ? 0 : line_ends_.back() + 1;
+  } else {
+    ClearIndex();
+    contents_.clear();
+  }
+  DEBUG_PRINTF("Index the history from %zu to %zu", offset, size);
+
+  ReadUpTo(fd, size);
+  close(fd);
+  device_ = buf.st_dev;
+  inode_  = buf.st_ino;
+  mtime_  = buf.st_mtim;
+  IndexFrom(offset);
+  return common::status_t::kSuccess;
+}
+
+size_t HistoryStore::LineCount() const {
+  auto complete_size = line_ends_.empty() ? 0 : line_ends_.back() + 1;
+  return line_ends_.size() + (contents_.size() > complete_size ? 1 : 0);
+}
+
+size_t HistoryStore::CompleteLineCount() const {
+  return line_ends_.size();
+}
+
+uint64_t HistoryStore::Generation() const {
+  return generation_;
+}
+
+ByteView HistoryStore::Line(size_t index) const {
+  if (index >= LineCount()) return {nullptr, 0};
+
+  size_t start = index == 0 ? 0 : line_ends_[index - 1] + 1;
+  size_t end   = index < line_ends_.size() ? line_ends_[index]
+                                           : contents_.size();
+  return {contents_.data() + start, end - start};
+}
+
+bool HistoryStore::IsAppendedTo(const int32_t &fd, size_t size) const {
+  if (size < contents_.size()) return false;
+
+  auto tail_size = std::min(kTailSize, contents_.size());
+  auto offset    = contents_.size() - tail_size;
+  uint8_t tail[kTailSize];
+  return pread(fd, tail, tail_size, offset) ==
+             static_cast<ssize_t>(tail_size) &&
+         std::memcmp(tail, contents_.data() + offset, tail_size) == 0;
+}
+
+void HistoryStore::ReadUpTo(const int32_t &fd, size_t size) {
+  auto offset = contents_.size();
+  if (size <= offset) return;
+
+  contents_.resize(size);
+  while (offset < size) {
+    auto ret = pread(fd, contents_.data() + offset, size - offset, offset);
+    if (ret == -1 && errno == EINTR) continue;
+    // The file was truncated meanwhile, or cannot be read
+    if (ret <= 0) break;
+    offset += ret;
+  }
+  contents_.resize(offset);
+}
+
+void HistoryStore::IndexFrom(size_t offset) {
+  const uint8_t *begin = contents_.data();
+  auto p   = begin + offset;
+  auto end = begin + contents_.size();
+  while (p < end) {
+    auto newline =
+        static_cast<const uint8_t *>(std::memchr(p, '\n', end - p));
+    if (newline == nullptr) break;
+    line_ends_.push_back(newline - begin);
+    p = newline + 1;
+  }
+}
+
+void HistoryStore::ClearIndex() {
+  // A missing file which is still missing has not changed
+  if (line_ends_.empty() && contents_.empty()) return;
+  line_ends_.clear();
+  ++generation_;
+}
+
+}  // namespace util
@@ -0,0 +1,71 @@
+/****************************************************************************
+ * history_store.h
+ *
+ *   Copyright (c) 2026 Yoshinori Sugino
+ *   This software is released under the MIT License.
+ ****************************************************************************/
+#ifndef HISTORY_STORE_H_
+#define HISTORY_STORE_H_
+
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "byte_view.h"
+#include "common_type.h"
+
+namespace util {
+
+// The contents of the history file with an index of where its lines end.
+// Both are kept between searches and brought up to date from the size,
+// mtime and inode of the file, so lines appended by other sessions are
+// read and indexed without reading the rest again. The file is read into
+// memory rather than mapped: another session may truncate or rewrite it,
+// which would make the pages of a mapping fault with SIGBUS.
+class HistoryStore final {
+ public:
+  HistoryStore() = delete;
+  explicit HistoryStore(const std::string &path);
+  ~HistoryStore();
+  HistoryStore(const HistoryStore &) = delete;
+  HistoryStore &operator=(const HistoryStore &) = delete;
+
+  // A missing file is an empty history
+  common::status_t Refresh();
+  size_t LineCount() const;
+  // Lines which end with a newline, so appends do not change them
+  size_t CompleteLineCount() const;
+  // Changed whenever lines already read may have changed (e.g. the file
+  // was rotated), but not when lines are only appended
+  uint64_t Generation() const;
+  // Without the newline. Valid until the next Refresh().
+  ByteView Line(size_t index) const;
+
+ private:
+  // The last bytes which were read are read again, which tells an append
+  // from a rewrite
+  static constexpr const size_t kTailSize = 64;
+
+  bool IsAppendedTo(const int32_t &fd, size_t size) const;
+  // Reads the file from the end of contents_ up to size
+  void ReadUpTo(const int32_t &fd, size_t size);
+  void IndexFrom(size_t offset);
+  void ClearIndex();
+
+  std::string path_;
+  std::vector<uint8_t> contents_;
+  dev_t device_;
+  ino_t inode_;
+  struct timespec mtime_;
+  // Offsets of the newline which ends each complete line
+  std::vector<uint64_t> line_ends_;
+  uint64_t generation_;
+};
+
+}  // namespace util
+
+#endif  // HISTORY_STORE_H_
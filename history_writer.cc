@@ -6,42 +6,236 @@
  ****************************************************************************/
 #include "history_writer.h"
 
-#include <fstream>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+#include "debug.h"
+#include "write_all.h"
 
 namespace util {
 
-HistoryWriter::HistoryWriter(const std::string &path)
+namespace {
+
+constexpr const size_t kCountChunkSize = 64 * 1024;
+// Reserved up front, so that neither buffer grows while typing
+constexpr const size_t kLineReserve  = 4 * 1024;
+constexpr const size_t kQueueReserve = 64 * 1024;
+constexpr const uint64_t kNsPerMs = 1000000;
+
+uint64_t nowNs() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return static_cast<uint64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+}  // namespace
+
+HistoryWriter::HistoryWriter(const std::string &path, size_t max_lines,
+                             history_sync_t sync_policy,
+                             uint64_t sync_interval_ns)
   : path_to_history_(path),
-    history_buffer_() {
+    path_to_previous_(path + ".1"),
+    max_lines_(max_lines),
+    sync_policy_(sync_policy),
+    sync_interval_ns_(sync_interval_ns),
+    lock_(path + ".lock"),
+    line_(),
+    queued_(),
+    queued_lines_(0),
+    queued_ns_(0),
+    file_fd_(-1),
+    file_inode_(0),
+    counted_inode_(0),
+    counted_size_(0),
+    line_count_(0) {
+  line_.reserve(kLineReserve);
+  queued_.reserve(kQueueReserve);
 }
 
 HistoryWriter::~HistoryWriter() {
+  (void)Flush();
+  CloseFile();
 }
 
-void HistoryWriter::AddStr(std::list<uint8_t> str) {
-  history_buffer_.splice(history_buffer_.end(), str);
+void HistoryWriter::AddStr(const ByteView &str) {
+  line_.insert(line_.end(), str.begin(), str.end());
 }
 
 void HistoryWriter::PopBack() {
-  if (!history_buffer_.empty()) history_buffer_.pop_back();
+  if (!line_.empty()) line_.pop_back();
+}
+
+void HistoryWriter::Clear() {
+  line_.clear();
 }
 
 common::status_t HistoryWriter::Write() {
-  if (history_buffer_.empty()) return common::status_t::kSuccess;
+  if (line_.empty()) return common::status_t::kSuccess;
+
+  // The queue is flushed before a line which does not fit into it, so
+  // that it grows only for a line longer than the reserve
+  auto ret = common::status_t::kSuccess;
+  if (queued_.size() + line_.size() + 1 > queued_.capacity()) ret = Flush();
+
+  if (queued_lines_ == 0) queued_ns_ = nowNs();
+  queued_.insert(queued_.end(), line_.begin(), line_.end());
+  queued_.push_back('\n');
+  ++queued_lines_;
+  line_.clear();
+
+  if ((sync_policy_ == history_sync_t::kEveryLine ||
+       sync_policy_ == history_sync_t::kEveryLineSync ||
+       queued_.size() >= kQueueReserve) &&
+      Flush() == common::status_t::kFailure)
+    ret = common::status_t::kFailure;
+  return ret;
+}
+
+common::status_t HistoryWriter::Flush() {
+  if (queued_lines_ == 0) return common::status_t::kSuccess;
+
+  // Without a lock file (e.g. in a read-only directory) the history is
+  // still written, only not in step with other sessions
+  auto is_locked = lock_.Lock(true) == common::status_t::kSuccess;
+  auto ret = AppendQueued();
+  if (is_locked) lock_.Unlock();
+
+  // Lines which cannot be written are dropped rather than retried on
+  // every tick
+  if (ret == common::status_t::kFailure)
+    DEBUG_PRINTF("Fail to append %zu lines to the history", queued_lines_);
+  queued_.clear();
+  queued_lines_ = 0;
+  return ret;
+}
+
+int32_t HistoryWriter::TimeoutMs() const {
+  if (sync_policy_ != history_sync_t::kPeriodic || queued_lines_ == 0)
+    return -1;
+
+  auto elapsed_ns = nowNs() - queued_ns_;
+  if (elapsed_ns >= sync_interval_ns_) return 0;
+  return static_cast<int32_t>(std::min<uint64_t>(
+      (sync_interval_ns_ - elapsed_ns + kNsPerMs - 1) / kNsPerMs,
+      INT32_MAX));
+}
+
+bool HistoryWriter::IsFlushDue() const {
+  return sync_policy_ == history_sync_t::kPeriodic && queued_lines_ > 0 &&
+         nowNs() - queued_ns_ >= sync_interval_ns_;
+}
 
-  std::ofstream ofs(path_to_history_, std::ios::app);
+// Called with the lock held. The queued lines are appended in as few
+// writes as the rotation allows.
+common::status_t HistoryWriter::AppendQueued() {
+  CountLines();
+  // The file may have been rotated by another session
+  if (file_fd_ != -1 && file_inode_ != counted_inode_) CloseFile();
 
-  if (!ofs.is_open()) return common::status_t::kFailure;
+  const uint8_t *p = queued_.data();
+  const uint8_t *end = p + queued_.size();
+  while (p < end) {
+    if (line_count_ >= max_lines_) {
+      Rotate();
+      CloseFile();
+    }
+    if (file_fd_ == -1 && OpenFile() == common::status_t::kFailure)
+      return common::status_t::kFailure;
 
-  for (const auto &c : history_buffer_) {
-    ofs << c;
+    // As many lines as fit into the current generation, and at least one
+    // if it could not be rotated
+    auto chunk_end = p;
+    do {
+      chunk_end = static_cast<const uint8_t *>(
+                      std::memchr(chunk_end, '\n', end - chunk_end)) +
+                  1;
+      ++line_count_;
+    } while (chunk_end < end && line_count_ < max_lines_);
+    auto size = static_cast<size_t>(chunk_end - p);
+    if (WriteAll(file_fd_, p, size) == common::status_t::kFailure)
+      return common::status_t::kFailure;
+    // What this writer appended need not be read to be counted
+    counted_size_ += size;
+    p = chunk_end;
   }
-  ofs << std::endl;
 
-  history_buffer_.clear();
+  if (sync_policy_ == history_sync_t::kEveryLineSync &&
+      fdatasync(file_fd_) == -1)
+    return common::status_t::kFailure;
+  return common::status_t::kSuccess;
+}
+
+// Only the bytes which were added since the last call are read, so the
+// count costs O(1) per written line
+void HistoryWriter::CountLines() {
+  struct stat buf;
+  if (stat(path_to_history_.c_str(), &buf) == -1) {
+    counted_inode_ = 0;
+    counted_size_  = 0;
+    line_count_    = 0;
+    return;
+  }
+  auto size = static_cast<uint64_t>(buf.st_size);
+  if (buf.st_ino != counted_inode_ || size < counted_size_) {
+    counted_inode_ = buf.st_ino;
+    counted_size_  = 0;
+    line_count_    = 0;
+  }
+  if (size == counted_size_) return;
 
+  auto fd = open(path_to_history_.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd == -1) return;
+  uint8_t chunk[kCountChunkSize];
+  while (counted_size_ < size) {
+    auto ret = pread(fd, chunk, sizeof(chunk), counted_size_);
+    if (ret <= 0) break;
+    for (ssize_t i = 0; i < ret; ++i) {
+      if (chunk[i] == '\n') ++line_count_;
+    }
+    counted_size_ += ret;
+  }
+  close(fd);
+}
+
+void HistoryWriter::Rotate() {
+  DEBUG_PRINTF("Rotate the history (%zu lines)", line_count_);
+  if (std::rename(path_to_history_.c_str(), path_to_previous_.c_str()) == -1)
+    return;
+  counted_inode_ = 0;
+  counted_size_  = 0;
+  line_count_    = 0;
+}
+
+common::status_t HistoryWriter::OpenFile() {
+  file_fd_ = open(path_to_history_.c_str(),
+                  O_WRONLY | O_APPEND | O_CREAT | O_CLOEXEC, 0600);
+  if (file_fd_ == -1) return common::status_t::kFailure;
+
+  struct stat buf;
+  if (fstat(file_fd_, &buf) == -1) {
+    CloseFile();
+    return common::status_t::kFailure;
+  }
+  file_inode_ = buf.st_ino;
+  // A file created here has no lines yet
+  if (buf.st_ino != counted_inode_) {
+    counted_inode_ = buf.st_ino;
+    counted_size_  = static_cast<uint64_t>(buf.st_size);
+    line_count_    = 0;
+  }
   return common::status_t::kSuccess;
 }
 
-}  // namespace util
+void HistoryWriter::CloseFile() {
+  if (file_fd_ != -1) close(file_fd_);
+  file_fd_    = -1;
+  file_inode_ = 0;
+}
 
+}  // namespace util
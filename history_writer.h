@@ -7,30 +7,83 @@
 #ifndef HISTORY_WRITER_H_
 #define HISTORY_WRITER_H_
 
+#include <sys/types.h>
+
+#include <cstddef>
 #include <cstdint>
-#include <list>
 #include <string>
+#include <vector>
 
+#include "byte_view.h"
 #include "common_type.h"
+#include "file_lock.h"
 
 namespace util {
 
+enum class history_sync_t : uint8_t {
+  kOnExit,         // When the writer is destroyed
+  kPeriodic,       // At most sync_interval_ns after a line has ended
+  kEveryLine,      // When each line ends
+  kEveryLineSync   // When each line ends, flushed to the disk
+};
+
+// Appends lines to the history, which is kept in two generations: path
+// and path.1. When path holds max_lines lines, it is renamed to path.1,
+// which drops the older generation at the cost of one rename. Writers of
+// all sessions take an exclusive lock on path.lock.
+//
+// The line is built in a buffer which is allocated once. Ended lines are
+// queued and appended together through one descriptor, which is kept open,
+// as the sync policy says. So typing and ending a line neither allocate
+// nor touch the file system, unless the policy appends every line.
 class HistoryWriter final {
  public:
   HistoryWriter() = delete;
-  explicit HistoryWriter(const std::string &path);
+  HistoryWriter(const std::string &path, size_t max_lines,
+                history_sync_t sync_policy = history_sync_t::kEveryLine,
+                uint64_t sync_interval_ns = 0);
   ~HistoryWriter();
+  HistoryWriter(const HistoryWriter &) = delete;
+  HistoryWriter &operator=(const HistoryWriter &) = delete;
 
-  void AddStr(std::list<uint8_t> str);
+  void AddStr(const ByteView &str);
   void PopBack();
+  void Clear();
+  // Ends the line, which is queued unless it is empty
   common::status_t Write();
+  // Appends the queued lines
+  common::status_t Flush();
+  // Time until the queued lines are due (-1: none are)
+  int32_t TimeoutMs() const;
+  bool IsFlushDue() const;
 
  private:
+  common::status_t AppendQueued();
+  void CountLines();
+  void Rotate();
+  common::status_t OpenFile();
+  void CloseFile();
+
   std::string path_to_history_;
-  std::list<uint8_t> history_buffer_;
+  std::string path_to_previous_;
+  size_t max_lines_;
+  history_sync_t sync_policy_;
+  uint64_t sync_interval_ns_;
+  FileLock lock_;
+  std::vector<uint8_t> line_;
+  // Ended lines, each with its newline
+  std::vector<uint8_t> queued_;
+  size_t queued_lines_;
+  // When the oldest queued line ended
+  uint64_t queued_ns_;
+  int32_t file_fd_;
+  ino_t file_inode_;
+  // Lines in the first counted_size_ bytes of the file counted_inode_
+  ino_t counted_inode_;
+  uint64_t counted_size_;
+  size_t line_count_;
 };
 
 }  // namespace util
 
 #endif  // HISTORY_WRITER_H_
-
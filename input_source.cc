@@ -0,0 +1,143 @@
+/****************************************************************************
+ * input_source.cc
+ *
+ *   Copyright (c) 2026 Yoshinori Sugino
+ *   This software is released under the MIT License.
+ ****************************************************************************/
+#include "input_source.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+
+#include "debug.h"
+
+namespace util {
+
+namespace {
+
+// Sent pages are dropped in steps of this size, so that the resident set
+// does not grow with the input
+constexpr const size_t kReleaseSize = 1024 * 1024;
+
+}  // namespace
+
+InputSource::InputSource(int32_t fd)
+  : fd_(fd),
+    mapped_(nullptr),
+    mapped_size_(0),
+    offset_(0),
+    released_(0),
+    is_exhausted_(false) {
+}
+
+InputSource::~InputSource() {
+  Close();
+}
+
+common::status_t InputSource::Open() {
+  if (fd_ == -1) return common::status_t::kFailure;
+
+  if (isatty(fd_)) {
+    Finish();
+    return common::status_t::kSuccess;
+  }
+
+  struct stat buf;
+  if (fstat(fd_, &buf) == -1) return common::status_t::kFailure;
+
+  if (S_ISREG(buf.st_mode)) {
+    // Start from the current offset, like read() would
+    auto offset = lseek(fd_, 0, SEEK_CUR);
+    if (offset == -1 || offset >= buf.st_size) {
+      Finish();
+      return common::status_t::kSuccess;
+    }
+    auto mapped = mmap(nullptr, buf.st_size, PROT_READ, MAP_PRIVATE, fd_, 0);
+    if (mapped != MAP_FAILED) {
+      (void)madvise(mapped, buf.st_size, MADV_SEQUENTIAL);
+      mapped_      = static_cast<const uint8_t *>(mapped);
+      mapped_size_ = buf.st_size;
+      offset_      = offset;
+      released_    = 0;
+      return common::status_t::kSuccess;
+    }
+    DEBUG_PRINTF("Fail to map the input, read it instead");
+  }
+
+  auto flags = fcntl(fd_, F_GETFL, 0);
+  if (flags == -1) return common::status_t::kFailure;
+  if (fcntl(fd_, F_SETFL, flags | O_NONBLOCK) == -1)
+    return common::status_t::kFailure;
+
+  return common::status_t::kSuccess;
+}
+
+bool InputSource::IsExhausted() const {
+  return is_exhausted_;
+}
+
+int32_t InputSource::PollFd() const {
+  if (mapped_) return -1;
+  return fd_;
+}
+
+size_t InputSource::Fill(ByteRingBuffer &buffer, size_t max_size) {
+  if (is_exhausted_) return 0;
+
+  if (mapped_) {
+    auto size = buffer.Push(mapped_ + offset_,
+                            std::min(max_size, mapped_size_ - offset_));
+    offset_ += size;
+    if (offset_ == mapped_size_) {
+      Finish();
+    } else if (offset_ - released_ >= kReleaseSize) {
+      // Both are multiples of kReleaseSize, thus page aligned
+      auto end = offset_ / kReleaseSize * kReleaseSize;
+      (void)madvise(const_cast<uint8_t *>(mapped_) + released_,
+                    end - released_, MADV_DONTNEED);
+      released_ = end;
+    }
+    return size;
+  }
+
+  size_t filled = 0;
+  while (filled < max_size) {
+    auto ret = buffer.ReadFrom(fd_, max_size - filled);
+    if (ret > 0) {
+      filled += ret;
+      continue;
+    }
+    if (ret == -1 && errno == EINTR) continue;
+    // The producer has not written more yet
+    if (ret == -1 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+    // End of the input, or an error
+    Finish();
+    break;
+  }
+  return filled;
+}
+
+void InputSource::Unlock() {
+  if (mapped_)
+    (void)munlock(mapped_ + released_, mapped_size_ - released_);
+}
+
+void InputSource::Close() {
+  Finish();
+  if (fd_ != -1) close(fd_);
+  fd_ = -1;
+}
+
+void InputSource::Finish() {
+  if (mapped_) munmap(const_cast<uint8_t *>(mapped_), mapped_size_);
+  mapped_       = nullptr;
+  mapped_size_  = 0;
+  is_exhausted_ = true;
+}
+
+}  // namespace util
@@ -0,0 +1,60 @@
+/****************************************************************************
+ * input_source.h
+ *
+ *   Copyright (c) 2026 Yoshinori Sugino
+ *   This software is released under the MIT License.
+ ****************************************************************************/
+#ifndef INPUT_SOURCE_H_
+#define INPUT_SOURCE_H_
+
+#include <sys/types.h>
+
+#include <cstddef>
+#include <cstdint>
+
+#include "byte_ring_buffer.h"
+#include "common_type.h"
+
+namespace util {
+
+// Piped or redirected input which is streamed into the outbound buffer as
+// the device drains it. Regular files are mapped instead of read.
+class InputSource final {
+ public:
+  InputSource() = delete;
+  // Takes ownership of fd
+  explicit InputSource(int32_t fd);
+  ~InputSource();
+  InputSource(const InputSource &) = delete;
+  InputSource &operator=(const InputSource &) = delete;
+
+  // A terminal is not treated as input (it is exhausted from the start)
+  common::status_t Open();
+  bool IsExhausted() const;
+  // Descriptor to wait on for more data, -1 if data is always available.
+  // It stays open after exhaustion until Close(), so that it can be removed
+  // from a poller first.
+  int32_t PollFd() const;
+  // Moves up to max_size bytes into buffer and returns the number of moved
+  // bytes. Becomes exhausted at the end of the input or on an error.
+  size_t Fill(ByteRingBuffer &buffer, size_t max_size);
+  // Takes the mapping out of mlockall(), so that sent pages can still be
+  // dropped
+  void Unlock();
+  void Close();
+
+ private:
+  void Finish();
+
+  int32_t fd_;
+  const uint8_t *mapped_;
+  size_t mapped_size_;
+  size_t offset_;
+  // Pages before this offset have been dropped from the mapping
+  size_t released_;
+  bool is_exhausted_;
+};
+
+}  // namespace util
+
+#endif  // INPUT_SOURCE_H_
@@ -0,0 +1,83 @@
+/****************************************************************************
+ * latency_histogram.cc
+ *
+ *   Copyright (c) 2026 Yoshinori Sugino
+ *   This software is released under the MIT License.
+ ****************************************************************************/
+#include "latency_histogram.h"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+
+namespace util {
+
+constexpr const uint32_t LatencyHistogram::kSubBucketBits;
+constexpr const uint64_t LatencyHistogram::kSubBuckets;
+constexpr const uint32_t LatencyHistogram::kMaxValueBits;
+constexpr const uint64_t LatencyHistogram::kMaxValue;
+constexpr const size_t LatencyHistogram::kBucketCount;
+
+LatencyHistogram::LatencyHistogram()
+  : counts_(),
+    count_(0),
+    max_(0) {
+}
+
+LatencyHistogram::~LatencyHistogram() {
+}
+
+uint64_t LatencyHistogram::Count() const {
+  return count_;
+}
+
+uint64_t LatencyHistogram::Max() const {
+  return max_;
+}
+
+uint64_t LatencyHistogram::Percentile(double percentile) const {
+  if (count_ == 0) return 0;
+
+  // The rank of the value, counted from 1
+  auto rank = static_cast<uint64_t>(percentile / 100 * count_ + 0.5);
+  rank = std::max<uint64_t>(1, std::min(rank, count_));
+
+  uint64_t seen = 0;
+  for (size_t i = 0; i < kBucketCount; ++i) {
+    seen += counts_[i];
+    if (seen >= rank) return std::min(bucketHighestValue(i), max_);
+  }
+  return max_;
+}
+
+std::string LatencyHistogram::Format(const char *name,
+                                     const char *eol) const {
+  static const struct {
+    const char *label;
+    double percentile;
+  } kPercentiles[] = {
+    {"p50", 50}, {"p90", 90}, {"p99", 99}, {"p999", 99.9},
+  };
+
+  std::string str;
+  char line[96];
+  snprintf(line, sizeof(line), "%s_count %" PRIu64 "%s", name, count_, eol);
+  str += line;
+  for (const auto &p : kPercentiles) {
+    snprintf(line, sizeof(line), "%s_%s_us %.1f%s", name, p.label,
+             Percentile(p.percentile) / 1e3, eol);
+    str += line;
+  }
+  snprintf(line, sizeof(line), "%s_max_us %.1f%s", name, max_ / 1e3, eol);
+  str += line;
+  return str;
+}
+
+uint64_t LatencyHistogram::bucketHighestValue(size_t index) {
+  if (index < kSubBuckets) return index;
+  uint32_t shift = index / kSubBuckets - 1;
+  auto lowest = (kSubBuckets + index % kSubBuckets) << shift;
+  return lowest + (1ULL << shift) - 1;
+}
+
+}  // namespace util
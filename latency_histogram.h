@@ -0,0 +1,65 @@
+/****************************************************************************
+ * latency_histogram.h
+ *
+ *   Copyright (c) 2026 Yoshinori Sugino
+ *   This software is released under the MIT License.
+ ****************************************************************************/
+#ifndef LATENCY_HISTOGRAM_H_
+#define LATENCY_HISTOGRAM_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace util {
+
+// Log-linear histogram of durations in nanoseconds, as in HdrHistogram:
+// each power of two is split into kSubBuckets linear buckets, so any
+// value is kept within 1/kSubBuckets (about 3 %) of its true value.
+// Recording is an index computation and an increment.
+class LatencyHistogram final {
+ public:
+  LatencyHistogram();
+  ~LatencyHistogram();
+
+  void Record(uint64_t value_ns) {
+    if (value_ns > kMaxValue) value_ns = kMaxValue;
+    ++counts_[bucketIndex(value_ns)];
+    ++count_;
+    if (value_ns > max_) max_ = value_ns;
+  }
+
+  uint64_t Count() const;
+  uint64_t Max() const;
+  // The highest value of the bucket holding the given percentile (0-100)
+  uint64_t Percentile(double percentile) const;
+  // "<name>_count", "<name>_p50_us", ... "<name>_max_us" lines
+  std::string Format(const char *name, const char *eol) const;
+
+ private:
+  static constexpr const uint32_t kSubBucketBits = 5;
+  static constexpr const uint64_t kSubBuckets    = 1ULL << kSubBucketBits;
+  // About 18 minutes; longer durations are counted as this
+  static constexpr const uint32_t kMaxValueBits  = 40;
+  static constexpr const uint64_t kMaxValue = (1ULL << kMaxValueBits) - 1;
+  static constexpr const size_t kBucketCount =
+      (kMaxValueBits - kSubBucketBits + 1) * kSubBuckets;
+
+  // Values below kSubBuckets have a bucket each. Above, the exponent
+  // selects a group of kSubBuckets and the next bits the bucket in it.
+  static size_t bucketIndex(uint64_t value) {
+    if (value < kSubBuckets) return value;
+    uint32_t shift = 63 - __builtin_clzll(value) - kSubBucketBits;
+    return (shift + 1) * kSubBuckets +
+           ((value >> shift) & (kSubBuckets - 1));
+  }
+  static uint64_t bucketHighestValue(size_t index);
+
+  uint64_t counts_[kBucketCount];
+  uint64_t count_;
+  uint64_t max_;
+};
+
+}  // namespace util
+
+#endif  // LATENCY_HISTOGRAM_H_
@@ -0,0 +1,90 @@
+/****************************************************************************
+ * latency_recorder.cc
+ *
+ *   Copyright (c) 2026 Yoshinori Sugino
+ *   This software is released under the MIT License.
+ ****************************************************************************/
+#include "latency_recorder.h"
+
+namespace util {
+
+constexpr const size_t LatencyRecorder::kMaxKeyStamps;
+
+LatencyRecorder::LatencyRecorder(uint64_t quiet_ns)
+  : quiet_ns_(quiet_ns),
+    sent_offset_(0),
+    key_stamps_(),
+    key_stamp_head_(0),
+    key_stamp_count_(0),
+    is_command_pending_(false),
+    command_ns_(0),
+    first_response_ns_(0),
+    last_response_ns_(0),
+    key_histogram_(),
+    first_response_histogram_(),
+    response_end_histogram_() {
+}
+
+LatencyRecorder::~LatencyRecorder() {
+}
+
+void LatencyRecorder::KeysQueued(uint64_t now_ns, size_t queued_size) {
+  // Keys typed while the device is stalled are not timed
+  if (key_stamp_count_ == kMaxKeyStamps) return;
+
+  auto tail = (key_stamp_head_ + key_stamp_count_) % kMaxKeyStamps;
+  key_stamps_[tail] = {now_ns, sent_offset_ + queued_size};
+  ++key_stamp_count_;
+}
+
+void LatencyRecorder::CommandEntered(uint64_t now_ns) {
+  EndCommand();
+  is_command_pending_ = true;
+  command_ns_         = now_ns;
+  first_response_ns_  = 0;
+}
+
+void LatencyRecorder::Sent(uint64_t now_ns, size_t size) {
+  sent_offset_ += size;
+  while (key_stamp_count_ > 0 &&
+         key_stamps_[key_stamp_head_].end_offset <= sent_offset_) {
+    key_histogram_.Record(now_ns - key_stamps_[key_stamp_head_].read_ns);
+    key_stamp_head_ = (key_stamp_head_ + 1) % kMaxKeyStamps;
+    --key_stamp_count_;
+  }
+}
+
+void LatencyRecorder::Received(uint64_t now_ns) {
+  if (!is_command_pending_) return;
+
+  if (first_response_ns_ == 0) {
+    first_response_ns_ = now_ns;
+    first_response_histogram_.Record(now_ns - command_ns_);
+  } else if (now_ns - last_response_ns_ >= quiet_ns_) {
+    // Output after the quiet time belongs to no command
+    EndCommand();
+    return;
+  }
+  last_response_ns_ = now_ns;
+}
+
+void LatencyRecorder::Settle(uint64_t now_ns) {
+  if (is_command_pending_ && first_response_ns_ != 0 &&
+      now_ns - last_response_ns_ >= quiet_ns_)
+    EndCommand();
+}
+
+std::string LatencyRecorder::Format(const char *eol) const {
+  return key_histogram_.Format("key_latency", eol) +
+         first_response_histogram_.Format("response_first", eol) +
+         response_end_histogram_.Format("response_end", eol);
+}
+
+void LatencyRecorder::EndCommand() {
+  // A command without any response has no round trip
+  if (is_command_pending_ && first_response_ns_ != 0)
+    response_end_histogram_.Record(last_response_ns_ - command_ns_);
+  is_command_pending_ = false;
+}
+
+}  // namespace util
@@ -0,0 +1,68 @@
+/****************************************************************************
+ * latency_recorder.h
+ *
+ *   Copyright (c) 2026 Yoshinori Sugino
+ *   This software is released under the MIT License.
+ ****************************************************************************/
+#ifndef LATENCY_RECORDER_H_
+#define LATENCY_RECORDER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "latency_histogram.h"
+
+namespace util {
+
+// Times typed keys from their read on the local terminal until the device
+// has taken their last byte, and commands from the read of Enter until
+// the first byte of the response and until the response has ended.
+// A response ends with the last byte before the device has been quiet for
+// quiet_ns, which is only known once that time has passed; it is settled
+// on the next received data, the next command or Settle().
+class LatencyRecorder final {
+ public:
+  LatencyRecorder() = delete;
+  explicit LatencyRecorder(uint64_t quiet_ns);
+  ~LatencyRecorder();
+
+  // Keys read at now_ns of which the last byte is queued_size bytes away
+  // in the outbound buffer
+  void KeysQueued(uint64_t now_ns, size_t queued_size);
+  void CommandEntered(uint64_t now_ns);
+  void Sent(uint64_t now_ns, size_t size);
+  void Received(uint64_t now_ns);
+  void Settle(uint64_t now_ns);
+
+  std::string Format(const char *eol) const;
+
+ private:
+  struct KeyStamp {
+    uint64_t read_ns;
+    // Offset of the byte after the keys in everything sent
+    uint64_t end_offset;
+  };
+
+  void EndCommand();
+
+  static constexpr const size_t kMaxKeyStamps = 256;
+
+  uint64_t quiet_ns_;
+  uint64_t sent_offset_;
+  // Keys which have not been sent yet, in the order they were typed
+  KeyStamp key_stamps_[kMaxKeyStamps];
+  size_t key_stamp_head_;
+  size_t key_stamp_count_;
+  bool is_command_pending_;
+  uint64_t command_ns_;
+  uint64_t first_response_ns_;
+  uint64_t last_response_ns_;
+  LatencyHistogram key_histogram_;
+  LatencyHistogram first_response_histogram_;
+  LatencyHistogram response_end_histogram_;
+};
+
+}  // namespace util
+
+#endif  // LATENCY_RECORDER_H_
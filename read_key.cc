@@ -6,98 +6,222 @@
  ****************************************************************************/
 #include "read_key.h"
 
-#include <algorithm>
-#include <sys/select.h>
-#include <unistd.h>
-#include <utility>
-#include <vector>
+#include <cstring>
 
 namespace util {
 
 namespace {
 
-const std::vector<uint8_t> kKeycodeCtrlX{0x18};
-const std::vector<uint8_t> kKeycodeCtrlR{0x12};
-const std::vector<uint8_t> kKeycodeEnter{0x0d};
-const std::vector<uint8_t> kKeycodeDel{0x7f};
-const std::vector<uint8_t> kKeycodeEsc{0x1b};
-const std::vector<uint8_t> kKeycodeUp{0x1b, 0x5b, 0x41};
-const std::vector<uint8_t> kKeycodeDown{0x1b, 0x5b, 0x42};
-const std::vector<uint8_t> kKeycodeRight{0x1b, 0x5b, 0x43};
-const std::vector<uint8_t> kKeycodeLeft{0x1b, 0x5b, 0x44};
-
-struct KeyRecord {
-  const std::vector<uint8_t> keys;
-  const key_t                type;
-  uint32_t                   index;
-  bool                       is_matched;
+constexpr const size_t kMaxKeyLength = 6;
+
+struct KeySequence {
+  key_t   type;
+  uint8_t length;
+  uint8_t bytes[kMaxKeyLength];
 };
 
-// non-blocking
-bool isReadable(const int32_t &fd) {
-  fd_set fds_r;
-  struct timeval tv;
+const KeySequence kKeySequences[] = {
+  {key_t::kCtrlX, 1, {0x18}            },
+  {key_t::kCtrlR, 1, {0x12}            },
+  {key_t::kEnter, 1, {0x0d}            },
+  {key_t::kDel,   1, {0x7f}            },
+  {key_t::kEsc,   1, {0x1b}            },
+  {key_t::kUp,    3, {0x1b, 0x5b, 0x41}},
+  {key_t::kDown,  3, {0x1b, 0x5b, 0x42}},
+  {key_t::kRight, 3, {0x1b, 0x5b, 0x43}},
+  {key_t::kLeft,  3, {0x1b, 0x5b, 0x44}},
+  // ESC [ 2 0 0 ~
+  {key_t::kPasteBegin, 6, {0x1b, 0x5b, 0x32, 0x30, 0x30, 0x7e}},
+};
 
-  FD_ZERO(&fds_r);
-  FD_SET(fd, &fds_r);
-  tv.tv_sec  = 0;
-  tv.tv_usec = 0;
+// ESC [ 2 0 1 ~
+const uint8_t kPasteEndMarker[] = {0x1b, 0x5b, 0x32, 0x30, 0x31, 0x7e};
+
+constexpr const uint8_t kRoot = 0;
+constexpr const uint8_t kNone = 0xff;
+
+struct TrieNode {
+  uint8_t  next[256];
+  bool     has_children;
+  // The key which ends at this node (kOther if none)
+  key_t    key_type;
+  // The longest key which ends on the path to this node. Bytes which turn
+  // out not to be a complete key are reported as this type.
+  key_t    prefix_type;
+  // The bytes on the path to this node
+  ByteView bytes;
+};
 
-  auto ret = select(fd + 1, &fds_r, nullptr, nullptr, &tv);
-  if (ret == -1) return false;
+std::vector<TrieNode> buildTrie() {
+  TrieNode empty_node;
+  std::memset(empty_node.next, kNone, sizeof(empty_node.next));
+  empty_node.has_children = false;
+  empty_node.key_type     = key_t::kOther;
+  empty_node.prefix_type  = key_t::kOther;
+  empty_node.bytes        = {nullptr, 0};
+
+  std::vector<TrieNode> trie(1, empty_node);
+  for (const auto &sequence : kKeySequences) {
+    uint8_t state = kRoot;
+    for (uint8_t depth = 0; depth < sequence.length; ++depth) {
+      auto c = sequence.bytes[depth];
+      if (trie[state].next[c] == kNone) {
+        trie[state].next[c]      = trie.size();
+        trie[state].has_children = true;
+        empty_node.bytes         = {sequence.bytes, depth + 1u};
+        trie.push_back(empty_node);
+      }
+      state = trie[state].next[c];
+    }
+    trie[state].key_type = sequence.type;
+  }
 
-  if (FD_ISSET(fd, &fds_r)) {
-    return true;
-  } else {
-    return false;
+  // Children are always created after their parent
+  for (size_t state = 0; state < trie.size(); ++state) {
+    if (trie[state].key_type != key_t::kOther)
+      trie[state].prefix_type = trie[state].key_type;
+    for (const auto &next : trie[state].next) {
+      if (next != kNone) trie[next].prefix_type = trie[state].prefix_type;
+    }
   }
+  return trie;
+}
+
+const std::vector<TrieNode> &keyTrie() {
+  static const std::vector<TrieNode> trie = buildTrie();
+  return trie;
 }
 
 }  // namespace
 
-ReadKeyResult ReadKey(const int32_t &fd) {
-  ReadKeyResult result{};
-  result.key_type = key_t::kOther;
-
-  std::list<KeyRecord> key_table;
-  key_table.push_back({kKeycodeCtrlX, key_t::kCtrlX, 0, true});
-  key_table.push_back({kKeycodeCtrlR, key_t::kCtrlR, 0, true});
-  key_table.push_back({kKeycodeEnter, key_t::kEnter, 0, true});
-  key_table.push_back({kKeycodeDel,   key_t::kDel  , 0, true});
-  key_table.push_back({kKeycodeEsc,   key_t::kEsc  , 0, true});
-  key_table.push_back({kKeycodeUp,    key_t::kUp   , 0, true});
-  key_table.push_back({kKeycodeDown,  key_t::kDown , 0, true});
-  key_table.push_back({kKeycodeRight, key_t::kRight, 0, true});
-  key_table.push_back({kKeycodeLeft,  key_t::kLeft , 0, true});
-
-  while (true) {
-    if (!isReadable(fd)) break;
-    uint8_t read_char;
-    auto size = read(fd, &read_char, 1);
-    if (size != 1) break;
-    result.read_keys.push_back(read_char);
-
-    for (auto &key_record : key_table) {
-      if (key_record.is_matched == true) {
-        if (read_char == *(key_record.keys.begin() + key_record.index)) {
-          ++key_record.index;
-        } else {
-          key_record.is_matched = false;
-        }
-        if (key_record.keys.begin() + key_record.index == key_record.keys.end()) {
-          result.key_type = key_record.type;
-        }
+KeyDecoder::KeyDecoder()
+  : state_(kRoot),
+    is_pasting_(false),
+    paste_end_matched_(0),
+    events_() {
+  events_.reserve(64);
+}
+
+KeyDecoder::~KeyDecoder() {
+}
+
+const std::vector<KeyEvent> &KeyDecoder::Feed(const uint8_t *data,
+                                              size_t size) {
+  events_.clear();
+
+  size_t i = 0;
+  while (i < size) {
+    if (is_pasting_) {
+      i += DecodePaste(data + i, size - i);
+    } else {
+      i += DecodeKeys(data + i, size - i);
+    }
+  }
+  return events_;
+}
+
+bool KeyDecoder::HasPending() const {
+  return state_ != kRoot || paste_end_matched_ > 0;
+}
+
+const std::vector<KeyEvent> &KeyDecoder::Flush() {
+  events_.clear();
+  if (state_ != kRoot) EmitPending();
+  if (paste_end_matched_ > 0) {
+    events_.push_back({key_t::kPaste, {kPasteEndMarker, paste_end_matched_}});
+    paste_end_matched_ = 0;
+  }
+  return events_;
+}
+
+// Returns the number of consumed bytes. Stops after the paste begin marker.
+size_t KeyDecoder::DecodeKeys(const uint8_t *data, size_t size) {
+  const auto &trie = keyTrie();
+
+  // Start of the current run of bytes which are no key
+  size_t run_start = 0;
+  size_t i = 0;
+  while (i < size) {
+    auto next = trie[state_].next[data[i]];
+    if (state_ == kRoot) {
+      if (next == kNone) {
+        ++i;
+        continue;
       }
+      if (i > run_start)
+        events_.push_back({key_t::kOther, {data + run_start, i - run_start}});
+    } else if (next == kNone) {
+      // Not a known sequence; data[i] is decoded again from the root
+      EmitPending();
+      run_start = i;
+      continue;
     }
 
-    auto matched_count = std::count_if(
-        key_table.begin(), key_table.end(),
-        [](KeyRecord key_record) -> bool { return key_record.is_matched; });
-    if (matched_count == 0 || matched_count == 1) break;
+    state_ = next;
+    ++i;
+    if (!trie[state_].has_children) {
+      auto key_type = trie[state_].key_type;
+      events_.push_back({key_type, trie[state_].bytes});
+      state_ = kRoot;
+      if (key_type == key_t::kPasteBegin) {
+        is_pasting_ = true;
+        return i;
+      }
+    }
+    run_start = i;
   }
+  if (state_ == kRoot && size > run_start)
+    events_.push_back({key_t::kOther, {data + run_start, size - run_start}});
 
-  return result;
+  return size;
 }
 
-}  // namespace util
+// Returns the number of consumed bytes. Stops after the paste end marker.
+size_t KeyDecoder::DecodePaste(const uint8_t *data, size_t size) {
+  size_t run_start = 0;
+  size_t i = 0;
+  while (i < size) {
+    if (paste_end_matched_ == 0) {
+      auto esc = static_cast<const uint8_t *>(
+          std::memchr(data + i, kPasteEndMarker[0], size - i));
+      if (esc == nullptr) {
+        i = size;
+        break;
+      }
+      i = esc - data;
+    }
 
+    if (data[i] != kPasteEndMarker[paste_end_matched_]) {
+      // The held bytes were pasted text; data[i] is examined again
+      events_.push_back({key_t::kPaste, {kPasteEndMarker, paste_end_matched_}});
+      paste_end_matched_ = 0;
+      run_start = i;
+      continue;
+    }
+
+    if (paste_end_matched_ == 0 && i > run_start)
+      events_.push_back({key_t::kPaste, {data + run_start, i - run_start}});
+    ++paste_end_matched_;
+    ++i;
+    run_start = i;
+    if (paste_end_matched_ == sizeof(kPasteEndMarker)) {
+      events_.push_back(
+          {key_t::kPasteEnd, {kPasteEndMarker, sizeof(kPasteEndMarker)}});
+      paste_end_matched_ = 0;
+      is_pasting_ = false;
+      return i;
+    }
+  }
+  if (paste_end_matched_ == 0 && size > run_start)
+    events_.push_back({key_t::kPaste, {data + run_start, size - run_start}});
+
+  return size;
+}
+
+void KeyDecoder::EmitPending() {
+  const auto &node = keyTrie()[state_];
+  events_.push_back({node.prefix_type, node.bytes});
+  state_ = kRoot;
+}
+
+}  // namespace util
@@ -7,8 +7,11 @@
 #ifndef READ_KEY_H_
 #define READ_KEY_H_
 
+#include <cstddef>
 #include <cstdint>
-#include <list>
+#include <vector>
+
+#include "byte_view.h"
 
 namespace util {
 
@@ -22,17 +25,48 @@ enum class key_t : uint8_t {
   kDown,
   kRight,
   kLeft,
+  // Bracketed paste: kPasteBegin, kPaste (the pasted bytes), kPasteEnd
+  kPasteBegin,
+  kPaste,
+  kPasteEnd,
   kOther,
 };
 
-struct ReadKeyResult {
+// A decoded key, or a run of bytes which are no key (kOther)
+struct KeyEvent {
   key_t key_type;
-  std::list<uint8_t> read_keys;
+  ByteView bytes;
 };
 
-ReadKeyResult ReadKey(const int32_t &fd);
+// Decodes keys from a byte stream with a trie built once from the keycode
+// table. A key sequence split across chunks is kept until the next chunk.
+// Between the bracketed paste markers the bytes are not decoded but passed
+// on as kPaste runs.
+class KeyDecoder final {
+ public:
+  KeyDecoder();
+  ~KeyDecoder();
+
+  // The events refer to data, so they are valid as long as data is and
+  // until the next call
+  const std::vector<KeyEvent> &Feed(const uint8_t *data, size_t size);
+  // True while an incomplete key sequence or paste end marker is held
+  bool HasPending() const;
+  // Emits the held bytes as they are (e.g. a lone ESC)
+  const std::vector<KeyEvent> &Flush();
+
+ private:
+  size_t DecodeKeys(const uint8_t *data, size_t size);
+  size_t DecodePaste(const uint8_t *data, size_t size);
+  void EmitPending();
+
+  uint8_t state_;
+  bool is_pasting_;
+  // Number of bytes of the paste end marker seen so far
+  size_t paste_end_matched_;
+  std::vector<KeyEvent> events_;
+};
 
 }  // namespace util
 
 #endif  // READ_KEY_H_
-
@@ -0,0 +1,117 @@
+/****************************************************************************
+ * realtime_profile.cc
+ *
+ *   Copyright (c) 2026 Yoshinori Sugino
+ *   This software is released under the MIT License.
+ ****************************************************************************/
+#include "realtime_profile.h"
+
+#include <sys/mman.h>
+
+#include <cerrno>
+#include <cstring>
+
+#include "debug.h"
+
+namespace util {
+
+namespace {
+
+constexpr const size_t kStackPrefaultSize = 64 * 1024;
+
+// Touches the stack the loop will use, so that it is mapped before it is
+// locked
+void prefaultStack() {
+  volatile uint8_t stack[kStackPrefaultSize];
+  for (size_t i = 0; i < sizeof(stack); i += 4096) stack[i] = 0;
+}
+
+}  // namespace
+
+RealtimeProfile::RealtimeProfile(const Settings &settings)
+  : settings_(settings),
+    error_(),
+    is_affinity_set_(false),
+    old_affinity_(),
+    is_policy_set_(false),
+    old_policy_(SCHED_OTHER),
+    old_param_(),
+    is_memory_locked_(false) {
+}
+
+RealtimeProfile::~RealtimeProfile() {
+  if (is_memory_locked_) (void)munlockall();
+  if (is_policy_set_)
+    (void)sched_setscheduler(0, old_policy_, &old_param_);
+  if (is_affinity_set_)
+    (void)sched_setaffinity(0, sizeof(old_affinity_), &old_affinity_);
+}
+
+common::status_t RealtimeProfile::Apply() {
+  error_.clear();
+
+  if (settings_.cpu >= 0) {
+    cpu_set_t cpu_set;
+    CPU_ZERO(&cpu_set);
+    if (settings_.cpu >= CPU_SETSIZE) {
+      errno = EINVAL;
+      AddError("CPU affinity");
+    } else if (sched_getaffinity(0, sizeof(old_affinity_), &old_affinity_) ==
+               -1) {
+      AddError("CPU affinity");
+    } else {
+      CPU_SET(settings_.cpu, &cpu_set);
+      if (sched_setaffinity(0, sizeof(cpu_set), &cpu_set) == -1) {
+        AddError("CPU affinity");
+      } else {
+        is_affinity_set_ = true;
+      }
+    }
+  }
+
+  if (settings_.priority > 0) {
+    old_policy_ = sched_getscheduler(0);
+    struct sched_param param;
+    std::memset(&param, 0, sizeof(param));
+    param.sched_priority = settings_.priority;
+    if (old_policy_ == -1 || sched_getparam(0, &old_param_) == -1 ||
+        sched_setscheduler(0, SCHED_FIFO, &param) == -1) {
+      AddError("SCHED_FIFO");
+    } else {
+      is_policy_set_ = true;
+    }
+  }
+
+  if (settings_.lock_memory) {
+    prefaultStack();
+    // Only what exists now is locked. With MCL_FUTURE an allocation would
+    // fail once RLIMIT_MEMLOCK is reached. Mapped input files are locked
+    // page by page as they are read instead of all at once.
+    auto flags = MCL_CURRENT;
+#ifdef MCL_ONFAULT
+    flags |= MCL_ONFAULT;
+#endif  // MCL_ONFAULT
+    if (mlockall(flags) == -1) {
+      AddError("mlockall");
+    } else {
+      is_memory_locked_ = true;
+    }
+  }
+
+  DEBUG_PRINTF("affinity: %d, SCHED_FIFO: %d, mlockall: %d", is_affinity_set_,
+               is_policy_set_, is_memory_locked_);
+  return error_.empty() ? common::status_t::kSuccess
+                        : common::status_t::kFailure;
+}
+
+const std::string &RealtimeProfile::Error() const {
+  return error_;
+}
+
+void RealtimeProfile::AddError(const char *setting) {
+  if (!error_.empty()) error_ += ", ";
+  error_ += std::string("cannot set ") + setting + " (" + std::strerror(errno) +
+            ")";
+}
+
+}  // namespace util
@@ -0,0 +1,61 @@
+/****************************************************************************
+ * realtime_profile.h
+ *
+ *   Copyright (c) 2026 Yoshinori Sugino
+ *   This software is released under the MIT License.
+ ****************************************************************************/
+#ifndef REALTIME_PROFILE_H_
+#define REALTIME_PROFILE_H_
+
+#include <sched.h>
+
+#include <cstdint>
+#include <string>
+
+#include "common_type.h"
+
+namespace util {
+
+// Runs the calling thread with SCHED_FIFO on one CPU and locks the memory
+// in use, so that the I/O path is neither preempted by ordinary tasks nor
+// stalled by page faults. Threads started afterwards inherit the
+// scheduling. Whatever was applied is reverted in the destructor.
+class RealtimeProfile final {
+ public:
+  struct Settings {
+    // SCHED_FIFO priority, 1 to 99 (0: keep the policy)
+    int32_t priority;
+    // CPU to run on (-1: any)
+    int32_t cpu;
+    bool lock_memory;
+
+    Settings() : priority(0), cpu(-1), lock_memory(false) {}
+  };
+
+  RealtimeProfile() = delete;
+  explicit RealtimeProfile(const Settings &settings);
+  ~RealtimeProfile();
+  RealtimeProfile(const RealtimeProfile &) = delete;
+  RealtimeProfile &operator=(const RealtimeProfile &) = delete;
+
+  // Applies every setting it can. On failure, Error() tells which were not
+  // applied and why; the others stay in effect.
+  common::status_t Apply();
+  const std::string &Error() const;
+
+ private:
+  void AddError(const char *setting);
+
+  Settings settings_;
+  std::string error_;
+  bool is_affinity_set_;
+  cpu_set_t old_affinity_;
+  bool is_policy_set_;
+  int32_t old_policy_;
+  struct sched_param old_param_;
+  bool is_memory_locked_;
+};
+
+}  // namespace util
+
+#endif  // REALTIME_PROFILE_H_
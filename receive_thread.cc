@@ -0,0 +1,162 @@
+/****************************************************************************
+ * receive_thread.cc
+ *
+ *   Copyright (c) 2026 Yoshinori Sugino
+ *   This software is released under the MIT License.
+ ****************************************************************************/
+#include "receive_thread.h"
+
+#include <poll.h>
+#include <pthread.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <csignal>
+
+#include "debug.h"
+
+namespace util {
+
+namespace {
+
+constexpr const size_t kMaxReadSize = 64 * 1024;
+
+}  // namespace
+
+ReceiveThread::ReceiveThread(const int32_t &tty_fd, size_t ring_size)
+  : tty_fd_(tty_fd),
+    ring_(ring_size),
+    notify_fd_(eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK)),
+    stop_fd_(eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK)),
+    thread_(),
+    is_closed_(false),
+    overflow_bytes_(0),
+    read_calls_(0),
+    read_bytes_(0) {
+}
+
+ReceiveThread::~ReceiveThread() {
+  Stop();
+  if (notify_fd_ != -1) close(notify_fd_);
+  if (stop_fd_ != -1) close(stop_fd_);
+}
+
+common::status_t ReceiveThread::Start() {
+  if (notify_fd_ == -1 || stop_fd_ == -1) return common::status_t::kFailure;
+  if (thread_.joinable()) return common::status_t::kFailure;
+
+  // Signals must keep interrupting the main thread, so the receive thread
+  // inherits a mask which blocks all of them
+  sigset_t all_signals, old_signals;
+  sigfillset(&all_signals);
+  pthread_sigmask(SIG_SETMASK, &all_signals, &old_signals);
+  try {
+    thread_ = std::thread(&ReceiveThread::Run, this);
+  }
+  catch (...) {
+    pthread_sigmask(SIG_SETMASK, &old_signals, nullptr);
+    return common::status_t::kFailure;
+  }
+  pthread_sigmask(SIG_SETMASK, &old_signals, nullptr);
+
+  return common::status_t::kSuccess;
+}
+
+void ReceiveThread::Stop() {
+  if (!thread_.joinable()) return;
+
+  uint64_t value = 1;
+  (void)write(stop_fd_, &value, sizeof(value));
+  thread_.join();
+}
+
+int32_t ReceiveThread::NotifyFd() const {
+  return notify_fd_;
+}
+
+void ReceiveThread::Acknowledge() {
+  uint64_t value;
+  (void)read(notify_fd_, &value, sizeof(value));
+}
+
+size_t ReceiveThread::Peek(const uint8_t **data) {
+  return ring_.ReadableRegion(data);
+}
+
+void ReceiveThread::Release(size_t size) {
+  ring_.Release(size);
+}
+
+bool ReceiveThread::IsClosed() const {
+  return is_closed_.load(std::memory_order_acquire);
+}
+
+uint64_t ReceiveThread::OverflowBytes() const {
+  return overflow_bytes_.load(std::memory_order_relaxed);
+}
+
+uint64_t ReceiveThread::ReadCalls() const {
+  return read_calls_.load(std::memory_order_relaxed);
+}
+
+uint64_t ReceiveThread::ReadBytes() const {
+  return read_bytes_.load(std::memory_order_relaxed);
+}
+
+void ReceiveThread::Run() {
+  uint8_t discard_buffer[kMaxReadSize];
+
+  while (true) {
+    struct pollfd pfds[2] = {
+      {tty_fd_, POLLIN, 0},
+      {stop_fd_, POLLIN, 0},
+    };
+    if (poll(pfds, 2, -1) == -1) {
+      if (errno == EINTR) continue;
+      break;
+    }
+    if (pfds[1].revents & POLLIN) return;
+    if (pfds[0].revents == 0) continue;
+
+    uint8_t *region;
+    auto size = std::min(ring_.WritableRegion(&region), kMaxReadSize);
+    if (size == 0) {
+      // Keep draining the device and count what is lost
+      region = discard_buffer;
+      size   = sizeof(discard_buffer);
+    }
+
+    auto ret = read(tty_fd_, region, size);
+    // The counters have a single writer, this thread, so no
+    // read-modify-write is needed
+    read_calls_.store(read_calls_.load(std::memory_order_relaxed) + 1,
+                      std::memory_order_relaxed);
+    if (ret > 0)
+      read_bytes_.store(read_bytes_.load(std::memory_order_relaxed) + ret,
+                        std::memory_order_relaxed);
+    if (ret == -1 && (errno == EAGAIN || errno == EINTR)) continue;
+    if (ret <= 0) break;
+
+    if (region == discard_buffer) {
+      DEBUG_PRINTF("The receive ring overflowed");
+      overflow_bytes_.store(
+          overflow_bytes_.load(std::memory_order_relaxed) + ret,
+          std::memory_order_relaxed);
+    } else {
+      ring_.Commit(ret);
+      Notify();
+    }
+  }
+
+  is_closed_.store(true, std::memory_order_release);
+  Notify();
+}
+
+void ReceiveThread::Notify() {
+  uint64_t value = 1;
+  (void)write(notify_fd_, &value, sizeof(value));
+}
+
+}  // namespace util
@@ -0,0 +1,65 @@
+/****************************************************************************
+ * receive_thread.h
+ *
+ *   Copyright (c) 2026 Yoshinori Sugino
+ *   This software is released under the MIT License.
+ ****************************************************************************/
+#ifndef RECEIVE_THREAD_H_
+#define RECEIVE_THREAD_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+
+#include "common_type.h"
+#include "spsc_byte_ring.h"
+
+namespace util {
+
+// Drains the device into a lock-free ring on a dedicated thread, so that
+// a slow stdout cannot make the kernel's tty buffer overflow.
+// Received bytes which do not fit into the ring are dropped and counted.
+class ReceiveThread final {
+ public:
+  ReceiveThread() = delete;
+  ReceiveThread(const int32_t &tty_fd, size_t ring_size);
+  ~ReceiveThread();
+  ReceiveThread(const ReceiveThread &) = delete;
+  ReceiveThread &operator=(const ReceiveThread &) = delete;
+
+  common::status_t Start();
+  void Stop();
+
+  // Becomes readable when data has arrived or the device was closed
+  int32_t NotifyFd() const;
+  // Resets NotifyFd(). Call before draining with Peek()/Release().
+  void Acknowledge();
+  size_t Peek(const uint8_t **data);
+  void Release(size_t size);
+
+  bool IsClosed() const;
+  uint64_t OverflowBytes() const;
+  // read() calls on the device and the bytes they returned
+  uint64_t ReadCalls() const;
+  uint64_t ReadBytes() const;
+
+ private:
+  void Run();
+  void Notify();
+
+  int32_t tty_fd_;
+  SpscByteRing ring_;
+  int32_t notify_fd_;
+  int32_t stop_fd_;
+  std::thread thread_;
+  std::atomic<bool> is_closed_;
+  // Written by the receive thread only
+  std::atomic<uint64_t> overflow_bytes_;
+  std::atomic<uint64_t> read_calls_;
+  std::atomic<uint64_t> read_bytes_;
+};
+
+}  // namespace util
+
+#endif  // RECEIVE_THREAD_H_
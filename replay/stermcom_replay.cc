@@ -0,0 +1,246 @@
+/****************************************************************************
+ * replay/stermcom_replay.cc
+ *
+ *   Plays a capture written by stermcom -c to stdout or into a pseudo
+ *   terminal, at the original timing or as fast as possible.
+ *
+ *   Copyright (c) 2026 Yoshinori Sugino
+ *   This software is released under the MIT License.
+ ****************************************************************************/
+#include <fcntl.h>
+#include <libgen.h>
+#include <poll.h>
+#include <pty.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include "capture_format.h"
+
+namespace {
+
+constexpr const int32_t kReadyTimeoutMs = 60000;
+// Polls of 10 ms
+constexpr const uint32_t kDrainIdleCount = 20;
+
+enum class selection_t : uint8_t {
+  kReceived,
+  kSent,
+  kAll
+};
+
+struct Options {
+  bool is_max_speed;
+  bool use_pty;
+  selection_t selection;
+  std::string path_to_capture;
+
+  Options()
+    : is_max_speed(false), use_pty(false),
+      selection(selection_t::kReceived), path_to_capture() {}
+};
+
+uint64_t nowNs() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return static_cast<uint64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+void sleepUntil(uint64_t deadline_ns) {
+  struct timespec ts;
+  ts.tv_sec  = deadline_ns / 1000000000;
+  ts.tv_nsec = deadline_ns % 1000000000;
+  while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr) ==
+         EINTR) {
+  }
+}
+
+// What the program on the other side sends is read and thrown away, so
+// that it never blocks on a full pty
+void discardInput(int32_t fd) {
+  uint8_t sink[4096];
+  while (read(fd, sink, sizeof(sink)) > 0) {
+  }
+}
+
+bool writeAll(int32_t fd, const uint8_t *data, size_t size, bool is_pty) {
+  while (size > 0) {
+    auto ret = write(fd, data, size);
+    if (ret == -1 && errno == EINTR) continue;
+    if (ret == -1 && errno == EAGAIN) {
+      struct pollfd pfd = {fd, POLLOUT, 0};
+      if (is_pty) pfd.events |= POLLIN;
+      (void)poll(&pfd, 1, -1);
+      if (pfd.revents & POLLIN) discardInput(fd);
+      continue;
+    }
+    if (ret <= 0) return false;
+    data += ret;
+    size -= ret;
+  }
+  return true;
+}
+
+// Waits until a program has opened the slave and put it into raw mode
+bool waitForRawMode(int32_t master_fd, int32_t slave_fd) {
+  auto deadline = nowNs() + kReadyTimeoutMs * 1000000ull;
+  while (nowNs() < deadline) {
+    struct termios term;
+    if (tcgetattr(slave_fd, &term) == 0 && !(term.c_lflag & ICANON))
+      return true;
+    discardInput(master_fd);
+    usleep(10000);
+  }
+  return false;
+}
+
+// Waits until the program has read everything from the slave. Data on its
+// way through the pty is not counted by FIONREAD yet, so the queue has to
+// stay empty for a while.
+void waitForDrain(int32_t master_fd, int32_t slave_fd) {
+  auto deadline = nowNs() + kReadyTimeoutMs * 1000000ull;
+  uint32_t idle_count = 0;
+  int32_t pending;
+  while (idle_count < kDrainIdleCount && nowNs() < deadline &&
+         ioctl(slave_fd, FIONREAD, &pending) == 0) {
+    idle_count = pending > 0 ? 0 : idle_count + 1;
+    discardInput(master_fd);
+    usleep(10000);
+  }
+}
+
+bool parseOptions(int argc, char *argv[], Options *opts) {
+  int opt_char;
+  while ((opt_char = getopt(argc, argv, "d:mp")) != -1) {
+    switch (opt_char) {
+      case 'd': {
+        if (std::strcmp(optarg, "received") == 0) {
+          opts->selection = selection_t::kReceived;
+        } else if (std::strcmp(optarg, "sent") == 0) {
+          opts->selection = selection_t::kSent;
+        } else if (std::strcmp(optarg, "all") == 0) {
+          opts->selection = selection_t::kAll;
+        } else {
+          return false;
+        }
+        break;
+      }
+      case 'm': {
+        opts->is_max_speed = true;
+        break;
+      }
+      case 'p': {
+        opts->use_pty = true;
+        break;
+      }
+      default: {
+        return false;
+      }
+    }
+  }
+  if (optind + 1 != argc) return false;
+
+  opts->path_to_capture = argv[optind];
+  return true;
+}
+
+}  // namespace
+
+int main(int argc, char *argv[]) {
+  Options opts;
+  if (!parseOptions(argc, argv, &opts)) {
+    printf("USAGE: %s [-m] [-p] [-d received|sent|all] capture_file\n",
+           basename(argv[0]));
+    return EXIT_FAILURE;
+  }
+
+  auto fd = open(opts.path_to_capture.c_str(), O_RDONLY | O_CLOEXEC);
+  struct stat st;
+  if (fd == -1 || fstat(fd, &st) == -1 ||
+      static_cast<size_t>(st.st_size) < sizeof(util::CaptureFileHeader)) {
+    fprintf(stderr, "cannot read %s\n", opts.path_to_capture.c_str());
+    return EXIT_FAILURE;
+  }
+  auto map = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (map == MAP_FAILED) {
+    fprintf(stderr, "cannot map %s\n", opts.path_to_capture.c_str());
+    return EXIT_FAILURE;
+  }
+  auto begin = static_cast<const uint8_t *>(map);
+  auto end   = begin + st.st_size;
+  (void)madvise(map, st.st_size, MADV_SEQUENTIAL);
+
+  if (std::memcmp(begin, util::kCaptureMagic, sizeof(util::kCaptureMagic))) {
+    fprintf(stderr, "%s is not a capture\n", opts.path_to_capture.c_str());
+    return EXIT_FAILURE;
+  }
+
+  int32_t out_fd = STDOUT_FILENO;
+  int32_t slave_fd = -1;
+  if (opts.use_pty) {
+    if (openpty(&out_fd, &slave_fd, nullptr, nullptr, nullptr) == -1) {
+      fprintf(stderr, "cannot open a pty\n");
+      return EXIT_FAILURE;
+    }
+    (void)fcntl(out_fd, F_SETFL, fcntl(out_fd, F_GETFL) | O_NONBLOCK);
+    // The device side of a serial link is raw as well
+    struct termios term;
+    tcgetattr(slave_fd, &term);
+    cfmakeraw(&term);
+    term.c_lflag |= ICANON;
+    tcsetattr(slave_fd, TCSANOW, &term);
+
+    fprintf(stderr, "%s\n", ttyname(slave_fd));
+    if (!waitForRawMode(out_fd, slave_fd)) {
+      fprintf(stderr, "nobody has attached to %s\n", ttyname(slave_fd));
+      return EXIT_FAILURE;
+    }
+  }
+
+  uint64_t played = 0;
+  auto start_ns = nowNs();
+  auto record   = begin + sizeof(util::CaptureFileHeader);
+  while (record + sizeof(util::CaptureRecordHeader) <= end) {
+    util::CaptureRecordHeader header;
+    std::memcpy(&header, record, sizeof(header));
+    auto data = record + sizeof(header);
+    if (header.size > static_cast<size_t>(end - data)) {
+      fprintf(stderr, "the capture is truncated\n");
+      break;
+    }
+    record = data + header.size;
+
+    auto direction = static_cast<util::capture_direction_t>(header.direction);
+    if ((opts.selection == selection_t::kReceived &&
+         direction != util::capture_direction_t::kReceived) ||
+        (opts.selection == selection_t::kSent &&
+         direction != util::capture_direction_t::kSent))
+      continue;
+
+    if (!opts.is_max_speed) sleepUntil(start_ns + header.timestamp_ns);
+    if (!writeAll(out_fd, data, header.size, opts.use_pty)) {
+      fprintf(stderr, "cannot write the data\n");
+      return EXIT_FAILURE;
+    }
+    played += header.size;
+  }
+
+  auto elapsed = (nowNs() - start_ns) / 1e9;
+  if (opts.use_pty) waitForDrain(out_fd, slave_fd);
+  fprintf(stderr, "%llu bytes in %.3f s (%.1f MB/s)\n",
+          static_cast<unsigned long long>(played), elapsed,
+          elapsed > 0 ? played / elapsed / 1e6 : 0.0);
+
+  munmap(map, st.st_size);
+  return EXIT_SUCCESS;
+}
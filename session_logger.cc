@@ -0,0 +1,223 @@
+/****************************************************************************
+ * session_logger.cc
+ *
+ *   Copyright (c) 2026 Yoshinori Sugino
+ *   This software is released under the MIT License.
+ ****************************************************************************/
+#include "session_logger.h"
+
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sys/eventfd.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <csignal>
+#include <cstdio>
+
+#include "debug.h"
+#include "write_all.h"
+
+namespace util {
+
+namespace {
+
+// The writer is woken early only when this much is queued, otherwise it
+// collects bytes for kFlushIntervalMs to write them in large batches
+constexpr const size_t kWakeThreshold = 256 * 1024;
+constexpr const int32_t kFlushIntervalMs = 100;
+// A log file which could not be opened is tried again at this interval
+constexpr const uint64_t kReopenIntervalNs = 1000ULL * 1000000;
+
+uint64_t nowNs() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return static_cast<uint64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+}  // namespace
+
+SessionLogger::SessionLogger(const Settings &settings)
+  : settings_(settings),
+    ring_(settings.buffer_size),
+    file_fd_(-1),
+    wake_fd_(eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK)),
+    stop_fd_(eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK)),
+    thread_(),
+    dropped_bytes_(0),
+    unlogged_bytes_(0),
+    file_size_(0),
+    opened_ns_(0),
+    synced_ns_(0),
+    is_dirty_(false) {
+}
+
+SessionLogger::~SessionLogger() {
+  Stop();
+  if (wake_fd_ != -1) close(wake_fd_);
+  if (stop_fd_ != -1) close(stop_fd_);
+}
+
+common::status_t SessionLogger::Start() {
+  if (wake_fd_ == -1 || stop_fd_ == -1) return common::status_t::kFailure;
+  if (thread_.joinable()) return common::status_t::kFailure;
+  if (OpenFile() == common::status_t::kFailure)
+    return common::status_t::kFailure;
+
+  // Signals must keep interrupting the main thread
+  sigset_t all_signals, old_signals;
+  sigfillset(&all_signals);
+  pthread_sigmask(SIG_SETMASK, &all_signals, &old_signals);
+  try {
+    thread_ = std::thread(&SessionLogger::Run, this);
+  }
+  catch (...) {
+    pthread_sigmask(SIG_SETMASK, &old_signals, nullptr);
+    CloseFile();
+    return common::status_t::kFailure;
+  }
+  pthread_sigmask(SIG_SETMASK, &old_signals, nullptr);
+
+  return common::status_t::kSuccess;
+}
+
+void SessionLogger::Stop() {
+  if (!thread_.joinable()) return;
+
+  uint64_t value = 1;
+  (void)write(stop_fd_, &value, sizeof(value));
+  thread_.join();
+}
+
+void SessionLogger::Log(const uint8_t *data, size_t size) {
+  auto queued = ring_.Size();
+  auto pushed = ring_.Push(data, size);
+  if (pushed < size)
+    dropped_bytes_.fetch_add(size - pushed, std::memory_order_relaxed);
+
+  if (queued < kWakeThreshold && queued + pushed >= kWakeThreshold) {
+    uint64_t value = 1;
+    (void)write(wake_fd_, &value, sizeof(value));
+  }
+}
+
+uint64_t SessionLogger::DroppedBytes() const {
+  return dropped_bytes_.load(std::memory_order_relaxed);
+}
+
+uint64_t SessionLogger::UnloggedBytes() const {
+  return unlogged_bytes_.load(std::memory_order_relaxed);
+}
+
+void SessionLogger::Run() {
+  while (true) {
+    struct pollfd pfds[2] = {
+      {wake_fd_, POLLIN, 0},
+      {stop_fd_, POLLIN, 0},
+    };
+    if (poll(pfds, 2, kFlushIntervalMs) == -1 && errno != EINTR) break;
+    if (pfds[0].revents & POLLIN) {
+      uint64_t value;
+      (void)read(wake_fd_, &value, sizeof(value));
+    }
+
+    WriteQueued();
+    if (settings_.fsync_policy == fsync_policy_t::kPeriodic &&
+        nowNs() - synced_ns_ >= settings_.fsync_interval_ns)
+      Sync();
+
+    if (pfds[1].revents & POLLIN) break;
+  }
+
+  WriteQueued();
+  CloseFile();
+}
+
+common::status_t SessionLogger::OpenFile() {
+  file_fd_ = open(settings_.path.c_str(),
+                  O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+  if (file_fd_ == -1) {
+    // WriteQueued() tries again after kReopenIntervalNs
+    file_size_ = 0;
+    opened_ns_ = nowNs();
+    return common::status_t::kFailure;
+  }
+
+  struct stat st;
+  file_size_ = fstat(file_fd_, &st) == 0 ? st.st_size : 0;
+  opened_ns_ = synced_ns_ = nowNs();
+  is_dirty_  = false;
+  return common::status_t::kSuccess;
+}
+
+void SessionLogger::CloseFile() {
+  if (file_fd_ == -1) return;
+  if (settings_.fsync_policy != fsync_policy_t::kNever) Sync();
+  close(file_fd_);
+  file_fd_ = -1;
+}
+
+void SessionLogger::Rotate() {
+  // After a failed open there is nothing to rotate, and the generations
+  // which are kept are not shifted again
+  if (file_fd_ != -1) {
+    CloseFile();
+
+    // path.(keep - 1) -> path.keep, ..., path -> path.1
+    for (auto i = settings_.keep; i > 0; --i) {
+      auto from = i == 1 ? settings_.path
+                         : settings_.path + "." + std::to_string(i - 1);
+      auto to = settings_.path + "." + std::to_string(i);
+      (void)rename(from.c_str(), to.c_str());
+    }
+    if (settings_.keep == 0) (void)unlink(settings_.path.c_str());
+  }
+
+  if (OpenFile() == common::status_t::kFailure)
+    DEBUG_PRINTF("Fail to open the log file after rotation");
+}
+
+void SessionLogger::WriteQueued() {
+  const uint8_t *data;
+  size_t size;
+  while ((size = ring_.ReadableRegion(&data)) > 0) {
+    // A file which could not be opened is tried again, e.g. until its
+    // directory is writable again
+    if (file_fd_ == -1 && nowNs() - opened_ns_ >= kReopenIntervalNs)
+      (void)OpenFile();
+    if (settings_.rotate_interval_ns != 0 &&
+        nowNs() - opened_ns_ >= settings_.rotate_interval_ns)
+      Rotate();
+    if (settings_.max_size != 0 && file_fd_ != -1 &&
+        file_size_ >= settings_.max_size)
+      Rotate();
+    // A file which is still full (e.g. it could not be renamed) takes the
+    // whole region rather than none of it
+    if (file_fd_ != -1 && file_size_ < settings_.max_size)
+      size = std::min<uint64_t>(size, settings_.max_size - file_size_);
+
+    // Without a file the whole region is dropped
+    if (file_fd_ == -1 ||
+        WriteAll(file_fd_, data, size) == common::status_t::kFailure) {
+      unlogged_bytes_.fetch_add(size, std::memory_order_relaxed);
+    } else {
+      file_size_ += size;
+      is_dirty_ = true;
+    }
+    ring_.Release(size);
+  }
+
+  if (settings_.fsync_policy == fsync_policy_t::kEveryWrite) Sync();
+}
+
+void SessionLogger::Sync() {
+  if (file_fd_ != -1 && is_dirty_) (void)fdatasync(file_fd_);
+  is_dirty_  = false;
+  synced_ns_ = nowNs();
+}
+
+}  // namespace util
@@ -0,0 +1,93 @@
+/****************************************************************************
+ * session_logger.h
+ *
+ *   Copyright (c) 2026 Yoshinori Sugino
+ *   This software is released under the MIT License.
+ ****************************************************************************/
+#ifndef SESSION_LOGGER_H_
+#define SESSION_LOGGER_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <thread>
+
+#include "common_type.h"
+#include "spsc_byte_ring.h"
+
+namespace util {
+
+enum class fsync_policy_t : uint8_t {
+  kNever,
+  kOnRotate,   // Before a log file is closed
+  kPeriodic,   // Every Settings::fsync_interval_ns
+  kEveryWrite  // After each batch
+};
+
+// Writes the session transcript to a file on a dedicated thread.
+// Log() only copies into a lock-free ring, so the caller never waits on
+// the disk; bytes which do not fit are dropped and counted.
+class SessionLogger final {
+ public:
+  struct Settings {
+    std::string path;
+    size_t buffer_size;
+    // Rotate when the file would exceed max_size bytes (0: never)
+    uint64_t max_size;
+    // Rotate when the file is older than this (0: never)
+    uint64_t rotate_interval_ns;
+    // Number of rotated files (path.1 is the newest)
+    uint32_t keep;
+    fsync_policy_t fsync_policy;
+    uint64_t fsync_interval_ns;
+
+    Settings()
+      : path(), buffer_size(4 * 1024 * 1024), max_size(0),
+        rotate_interval_ns(0), keep(5),
+        fsync_policy(fsync_policy_t::kOnRotate), fsync_interval_ns(0) {}
+  };
+
+  SessionLogger() = delete;
+  explicit SessionLogger(const Settings &settings);
+  ~SessionLogger();
+  SessionLogger(const SessionLogger &) = delete;
+  SessionLogger &operator=(const SessionLogger &) = delete;
+
+  common::status_t Start();
+  // Writes what is queued and closes the file
+  void Stop();
+
+  // Called from one thread only
+  void Log(const uint8_t *data, size_t size);
+  uint64_t DroppedBytes() const;
+  // Bytes which could not be written, e.g. while the log file could not be
+  // opened again after a rotation
+  uint64_t UnloggedBytes() const;
+
+ private:
+  void Run();
+  common::status_t OpenFile();
+  void CloseFile();
+  void Rotate();
+  void WriteQueued();
+  void Sync();
+
+  Settings settings_;
+  SpscByteRing ring_;
+  int32_t file_fd_;
+  int32_t wake_fd_;
+  int32_t stop_fd_;
+  std::thread thread_;
+  std::atomic<uint64_t> dropped_bytes_;
+  std::atomic<uint64_t> unlogged_bytes_;
+  // Owned by the writer thread
+  uint64_t file_size_;
+  uint64_t opened_ns_;
+  uint64_t synced_ns_;
+  bool is_dirty_;
+};
+
+}  // namespace util
+
+#endif  // SESSION_LOGGER_H_
@@ -0,0 +1,110 @@
+/****************************************************************************
+ * session_stats.cc
+ *
+ *   Copyright (c) 2026 Yoshinori Sugino
+ *   This software is released under the MIT License.
+ ****************************************************************************/
+#include "session_stats.h"
+
+#include <sys/ioctl.h>
+#include <time.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <linux/serial.h>
+#endif  // __linux__
+
+#include <cinttypes>
+#include <cstdio>
+
+namespace util {
+
+namespace {
+
+uint64_t nowNs() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return static_cast<uint64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+void append(std::string *str, const char *name, uint64_t value,
+            const char *eol) {
+  char line[64];
+  snprintf(line, sizeof(line), "%s %" PRIu64 "%s", name, value, eol);
+  *str += line;
+}
+
+}  // namespace
+
+SessionStats::SessionStats()
+  : start_ns_(nowNs()),
+    wakeups_(0),
+    rx_calls_(0),
+    rx_bytes_(0),
+    rx_eagain_(0),
+    rx_thread_calls_(0),
+    rx_thread_bytes_(0),
+    rx_overflow_bytes_(0),
+    tx_calls_(0),
+    tx_bytes_(0),
+    tx_short_writes_(0),
+    tx_eagain_(0),
+    tx_queue_peak_(0) {
+}
+
+SessionStats::~SessionStats() {
+}
+
+std::string SessionStats::Format(const int32_t &tty_fd,
+                                 const char *eol) const {
+  std::string str;
+  char line[64];
+  snprintf(line, sizeof(line), "seconds %.3f%s",
+           (nowNs() - start_ns_) / 1e9, eol);
+  str += line;
+
+  append(&str, "wakeups", wakeups_, eol);
+  append(&str, "rx_bytes", rx_bytes_ + rx_thread_bytes_, eol);
+  append(&str, "rx_calls", rx_calls_ + rx_thread_calls_, eol);
+  append(&str, "rx_eagain", rx_eagain_, eol);
+  append(&str, "rx_overflow_bytes", rx_overflow_bytes_, eol);
+  append(&str, "tx_bytes", tx_bytes_, eol);
+  append(&str, "tx_calls", tx_calls_, eol);
+  append(&str, "tx_short_writes", tx_short_writes_, eol);
+  append(&str, "tx_eagain", tx_eagain_, eol);
+  append(&str, "tx_queue_peak", tx_queue_peak_, eol);
+
+  // Counted by the serial driver; pseudo terminals and most USB adapters
+  // without an interrupt endpoint do not have them
+#ifdef TIOCGICOUNT
+  struct serial_icounter_struct icount;
+  if (ioctl(tty_fd, TIOCGICOUNT, &icount) == 0) {
+    append(&str, "driver_rx", icount.rx, eol);
+    append(&str, "driver_tx", icount.tx, eol);
+    append(&str, "driver_overrun", icount.overrun, eol);
+    append(&str, "driver_buf_overrun", icount.buf_overrun, eol);
+    append(&str, "driver_frame", icount.frame, eol);
+    append(&str, "driver_parity", icount.parity, eol);
+    append(&str, "driver_brk", icount.brk, eol);
+  }
+#endif  // TIOCGICOUNT
+  return str;
+}
+
+common::status_t SessionStats::WriteFile(const std::string &path,
+                                         const std::string &text) {
+  auto temporary_path = path + ".tmp";
+  auto fp = std::fopen(temporary_path.c_str(), "w");
+  if (fp == nullptr) return common::status_t::kFailure;
+
+  auto is_written =
+      std::fwrite(text.data(), 1, text.size(), fp) == text.size();
+  if (std::fclose(fp) != 0 || !is_written ||
+      std::rename(temporary_path.c_str(), path.c_str()) != 0) {
+    (void)unlink(temporary_path.c_str());
+    return common::status_t::kFailure;
+  }
+  return common::status_t::kSuccess;
+}
+
+}  // namespace util
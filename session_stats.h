@@ -0,0 +1,89 @@
+/****************************************************************************
+ * session_stats.h
+ *
+ *   Copyright (c) 2026 Yoshinori Sugino
+ *   This software is released under the MIT License.
+ ****************************************************************************/
+#ifndef SESSION_STATS_H_
+#define SESSION_STATS_H_
+
+#include <sys/types.h>
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "common_type.h"
+
+namespace util {
+
+// Counters of the main loop. They are plain integers owned by the main
+// thread and updated inline, so they stay enabled at no measurable cost.
+// The counters of the driver are read only when the stats are formatted.
+class SessionStats final {
+ public:
+  SessionStats();
+  ~SessionStats();
+
+  void CountWakeup() { ++wakeups_; }
+
+  // ret and errno of a read() or splice() from the device
+  void CountReceive(ssize_t ret) {
+    ++rx_calls_;
+    if (ret > 0) {
+      rx_bytes_ += ret;
+    } else if (ret == -1 && errno == EAGAIN) {
+      ++rx_eagain_;
+    }
+  }
+
+  // ret and errno of a write to the device which offered size bytes
+  void CountSend(size_t size, ssize_t ret) {
+    ++tx_calls_;
+    if (ret > 0) {
+      tx_bytes_ += ret;
+      if (static_cast<size_t>(ret) < size) ++tx_short_writes_;
+    } else if (ret == -1 && errno == EAGAIN) {
+      ++tx_eagain_;
+    }
+  }
+
+  void CountQueueDepth(size_t size) {
+    if (size > tx_queue_peak_) tx_queue_peak_ = size;
+  }
+
+  // Totals of the receive thread, which reads the device on its own
+  void SetThreadReceive(uint64_t calls, uint64_t bytes,
+                        uint64_t overflow_bytes) {
+    rx_thread_calls_   = calls;
+    rx_thread_bytes_   = bytes;
+    rx_overflow_bytes_ = overflow_bytes;
+  }
+
+  // One "name value" pair per line
+  std::string Format(const int32_t &tty_fd, const char *eol) const;
+  // Replaces the file with text, so that a reader never sees a partial
+  // dump
+  static common::status_t WriteFile(const std::string &path,
+                                    const std::string &text);
+
+ private:
+  uint64_t start_ns_;
+  uint64_t wakeups_;
+  uint64_t rx_calls_;
+  uint64_t rx_bytes_;
+  uint64_t rx_eagain_;
+  uint64_t rx_thread_calls_;
+  uint64_t rx_thread_bytes_;
+  uint64_t rx_overflow_bytes_;
+  uint64_t tx_calls_;
+  uint64_t tx_bytes_;
+  uint64_t tx_short_writes_;
+  uint64_t tx_eagain_;
+  uint64_t tx_queue_peak_;
+};
+
+}  // namespace util
+
+#endif  // SESSION_STATS_H_
@@ -11,7 +11,8 @@
 namespace util {
 
 common::status_t InitializeSignalAction(void (*ignore_handler)(int32_t),
-                                        void (*disconnect_handler)(int32_t)) {
+                                        void (*disconnect_handler)(int32_t),
+                                        void (*stats_handler)(int32_t)) {
   struct sigaction signal_ignore;
 
   if (sigemptyset(&signal_ignore.sa_mask) == -1) {
@@ -26,8 +27,6 @@ common::status_t InitializeSignalAction(void (*ignore_handler)(int32_t),
     return common::status_t::kFailure;
   if (sigaction(SIGPIPE, &signal_ignore, nullptr) == -1)
     return common::status_t::kFailure;
-  if (sigaction(SIGUSR1, &signal_ignore, nullptr) == -1)
-    return common::status_t::kFailure;
   if (sigaction(SIGUSR2, &signal_ignore, nullptr) == -1)
     return common::status_t::kFailure;
 
@@ -44,6 +43,17 @@ common::status_t InitializeSignalAction(void (*ignore_handler)(int32_t),
   if (sigaction(SIGTERM, &signal_disconnect, nullptr) == -1)
     return common::status_t::kFailure;
 
+  struct sigaction signal_stats;
+
+  if (sigemptyset(&signal_stats.sa_mask) == -1) {
+    return common::status_t::kFailure;
+  }
+  signal_stats.sa_handler = stats_handler;
+  signal_stats.sa_flags   = 0;
+
+  if (sigaction(SIGUSR1, &signal_stats, nullptr) == -1)
+    return common::status_t::kFailure;
+
   return common::status_t::kSuccess;
 }
 
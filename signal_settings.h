@@ -11,8 +11,10 @@
 
 namespace util {
 
+// SIGUSR1 asks for the statistics
 common::status_t InitializeSignalAction(void (*ignore_handler)(int32_t),
-                                        void (*disconnect_handler)(int32_t));
+                                        void (*disconnect_handler)(int32_t),
+                                        void (*stats_handler)(int32_t));
 
 }  // namespace util
 
@@ -0,0 +1,115 @@
+/****************************************************************************
+ * splice_forwarder.cc
+ *
+ *   Copyright (c) 2026 Yoshinori Sugino
+ *   This software is released under the MIT License.
+ ****************************************************************************/
+#include "splice_forwarder.h"
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+
+#include "write_all.h"
+
+namespace util {
+
+SpliceForwarder::SpliceForwarder(const int32_t &out_fd)
+  : out_fd_(out_fd),
+    is_out_pipe_(false),
+    pipe_fds_{-1, -1} {
+}
+
+SpliceForwarder::~SpliceForwarder() {
+  if (pipe_fds_[0] != -1) close(pipe_fds_[0]);
+  if (pipe_fds_[1] != -1) close(pipe_fds_[1]);
+}
+
+common::status_t SpliceForwarder::Open() {
+#ifdef __linux__
+  if (isatty(out_fd_)) return common::status_t::kFailure;
+
+  struct stat buf;
+  if (fstat(out_fd_, &buf) == -1) return common::status_t::kFailure;
+
+  is_out_pipe_ = S_ISFIFO(buf.st_mode);
+  if (is_out_pipe_) return common::status_t::kSuccess;
+
+  // O_APPEND files cannot be the target of splice()
+  auto flags = fcntl(out_fd_, F_GETFL);
+  if (flags == -1 || (flags & O_APPEND)) return common::status_t::kFailure;
+
+  if (pipe2(pipe_fds_, O_CLOEXEC) == -1) return common::status_t::kFailure;
+  return common::status_t::kSuccess;
+#else
+  return common::status_t::kFailure;
+#endif  // __linux__
+}
+
+ssize_t SpliceForwarder::Forward(const int32_t &in_fd, size_t max_size) {
+#ifdef __linux__
+  if (is_out_pipe_) {
+    // Blocks like write() while the reader of the pipe is behind, even if
+    // the pipe was handed over non-blocking. EAGAIN is then returned only
+    // when in_fd has nothing to read.
+    while (true) {
+      auto ret =
+          splice(in_fd, nullptr, out_fd_, nullptr, max_size, SPLICE_F_MOVE);
+      if (ret != -1 || errno != EAGAIN) return ret;
+
+      struct pollfd pfd{out_fd_, POLLOUT, 0};
+      if (poll(&pfd, 1, 0) == 1) {
+        errno = EAGAIN;
+        return -1;
+      }
+      if (poll(&pfd, 1, -1) == -1 && errno != EINTR) return -1;
+    }
+  }
+
+  auto ret = splice(in_fd, nullptr, pipe_fds_[1], nullptr, max_size,
+                    SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+  if (ret <= 0) return ret;
+
+  // Everything taken from in_fd has to leave the pipe again
+  size_t rest = ret;
+  while (rest > 0) {
+    auto moved = splice(pipe_fds_[0], nullptr, out_fd_, nullptr, rest,
+                        SPLICE_F_MOVE);
+    if (moved > 0) {
+      rest -= moved;
+      continue;
+    }
+    if (moved == -1 && errno == EINTR) continue;
+    if (moved == -1 && errno == EAGAIN) {
+      struct pollfd pfd{out_fd_, POLLOUT, 0};
+      (void)poll(&pfd, 1, -1);
+      continue;
+    }
+    break;
+  }
+  if (rest == 0) return ret;
+
+  // The output refused splice(). Deliver what is already in the pipe with
+  // plain copies and let the caller fall back.
+  uint8_t buffer[4096];
+  while (rest > 0) {
+    auto size = read(pipe_fds_[0], buffer, sizeof(buffer));
+    if (size <= 0 ||
+        WriteAll(out_fd_, buffer, size) == common::status_t::kFailure)
+      break;
+    rest -= size;
+  }
+  errno = EINVAL;
+  return -1;
+#else
+  (void)in_fd;
+  (void)max_size;
+  errno = EINVAL;
+  return -1;
+#endif  // __linux__
+}
+
+}  // namespace util
@@ -0,0 +1,45 @@
+/****************************************************************************
+ * splice_forwarder.h
+ *
+ *   Copyright (c) 2026 Yoshinori Sugino
+ *   This software is released under the MIT License.
+ ****************************************************************************/
+#ifndef SPLICE_FORWARDER_H_
+#define SPLICE_FORWARDER_H_
+
+#include <sys/types.h>
+
+#include <cstddef>
+#include <cstdint>
+
+#include "common_type.h"
+
+namespace util {
+
+// Moves data from a descriptor to a pipe or a file with splice(2), so the
+// bytes never pass through userspace. When the output is not a pipe, an
+// internal pipe sits in between.
+class SpliceForwarder final {
+ public:
+  SpliceForwarder() = delete;
+  explicit SpliceForwarder(const int32_t &out_fd);
+  ~SpliceForwarder();
+  SpliceForwarder(const SpliceForwarder &) = delete;
+  SpliceForwarder &operator=(const SpliceForwarder &) = delete;
+
+  // Fails when out_fd is a terminal or splice() is unavailable
+  common::status_t Open();
+  // Returns the number of moved bytes, 0 at the end of in_fd or -1 on error.
+  // errno is EINVAL when splice() is not supported by either side. Nothing
+  // is lost in that case, and the caller should fall back to read()/write().
+  ssize_t Forward(const int32_t &in_fd, size_t max_size);
+
+ private:
+  int32_t out_fd_;
+  bool is_out_pipe_;
+  int32_t pipe_fds_[2];
+};
+
+}  // namespace util
+
+#endif  // SPLICE_FORWARDER_H_
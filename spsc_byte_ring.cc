@@ -0,0 +1,90 @@
+/****************************************************************************
+ * spsc_byte_ring.cc
+ *
+ *   Copyright (c) 2026 Yoshinori Sugino
+ *   This software is released under the MIT License.
+ ****************************************************************************/
+#include "spsc_byte_ring.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace util {
+
+namespace {
+
+size_t roundUpToPowerOfTwo(size_t value) {
+  size_t result = 1;
+  while (result < value) result <<= 1;
+  return result;
+}
+
+}  // namespace
+
+// head_ and tail_ count bytes since the start and are never wrapped, so
+// tail_ - head_ is the number of stored bytes.
+SpscByteRing::SpscByteRing(size_t capacity)
+  : buffer_(roundUpToPowerOfTwo(std::max<size_t>(capacity, 1))),
+    mask_(buffer_.size() - 1),
+    padding_before_head_(),
+    head_(0),
+    padding_before_tail_(),
+    tail_(0),
+    padding_after_tail_() {
+}
+
+SpscByteRing::~SpscByteRing() {
+}
+
+size_t SpscByteRing::Capacity() const {
+  return buffer_.size();
+}
+
+size_t SpscByteRing::Size() const {
+  return tail_.load(std::memory_order_acquire) -
+         head_.load(std::memory_order_acquire);
+}
+
+size_t SpscByteRing::WritableRegion(uint8_t **region) {
+  auto tail = tail_.load(std::memory_order_relaxed);
+  auto head = head_.load(std::memory_order_acquire);
+
+  auto free  = buffer_.size() - (tail - head);
+  auto index = tail & mask_;
+  *region = &buffer_[index];
+  return std::min(free, buffer_.size() - index);
+}
+
+void SpscByteRing::Commit(size_t size) {
+  tail_.store(tail_.load(std::memory_order_relaxed) + size,
+              std::memory_order_release);
+}
+
+size_t SpscByteRing::Push(const uint8_t *data, size_t size) {
+  size_t pushed = 0;
+  while (pushed < size) {
+    uint8_t *region;
+    auto len = std::min(WritableRegion(&region), size - pushed);
+    if (len == 0) break;
+    std::memcpy(region, data + pushed, len);
+    Commit(len);
+    pushed += len;
+  }
+  return pushed;
+}
+
+size_t SpscByteRing::ReadableRegion(const uint8_t **region) {
+  auto head = head_.load(std::memory_order_relaxed);
+  auto tail = tail_.load(std::memory_order_acquire);
+
+  auto index = head & mask_;
+  *region = &buffer_[index];
+  return std::min(tail - head, buffer_.size() - index);
+}
+
+void SpscByteRing::Release(size_t size) {
+  head_.store(head_.load(std::memory_order_relaxed) + size,
+              std::memory_order_release);
+}
+
+}  // namespace util
@@ -0,0 +1,58 @@
+/****************************************************************************
+ * spsc_byte_ring.h
+ *
+ *   Copyright (c) 2026 Yoshinori Sugino
+ *   This software is released under the MIT License.
+ ****************************************************************************/
+#ifndef SPSC_BYTE_RING_H_
+#define SPSC_BYTE_RING_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace util {
+
+// Lock-free byte FIFO shared by exactly one producer thread and one
+// consumer thread. Both sides work on contiguous regions in place, so no
+// intermediate copy is needed.
+class SpscByteRing final {
+ public:
+  SpscByteRing() = delete;
+  // The capacity is rounded up to a power of two
+  explicit SpscByteRing(size_t capacity);
+  ~SpscByteRing();
+  SpscByteRing(const SpscByteRing &) = delete;
+  SpscByteRing &operator=(const SpscByteRing &) = delete;
+
+  size_t Capacity() const;
+  size_t Size() const;
+
+  // Producer side
+  size_t WritableRegion(uint8_t **region);
+  void Commit(size_t size);
+  size_t Push(const uint8_t *data, size_t size);
+
+  // Consumer side
+  size_t ReadableRegion(const uint8_t **region);
+  void Release(size_t size);
+
+ private:
+  static constexpr size_t kCacheLineSize = 64;
+
+  // head_ and tail_ are kept on cache lines of their own to avoid false
+  // sharing. Padding does this wherever the ring is placed, as new in C++11
+  // ignores alignas beyond the alignment of max_align_t.
+  std::vector<uint8_t> buffer_;
+  size_t mask_;
+  uint8_t padding_before_head_[kCacheLineSize];
+  std::atomic<size_t> head_;
+  uint8_t padding_before_tail_[kCacheLineSize];
+  std::atomic<size_t> tail_;
+  uint8_t padding_after_tail_[kCacheLineSize];
+};
+
+}  // namespace util
+
+#endif  // SPSC_BYTE_RING_H_
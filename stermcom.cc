@@ -5,49 +5,175 @@
  *   This software is released under the MIT License.
  ****************************************************************************/
 #include <fcntl.h>
+#include <getopt.h>
 #include <libgen.h>
 #include <sys/file.h>
-#include <sys/select.h>
+#include <time.h>
 #include <unistd.h>
 
-#include <cassert>
+#include <algorithm>
 #include <cerrno>
 #include <csignal>
 #include <cstdint>
 #include <cstdio>
 #include <cstdlib>
-#include <list>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
 
+#include "aho_corasick.h"
+#include "byte_ring_buffer.h"
+#include "capture_writer.h"
 #include "common_type.h"
 #include "debug.h"
+#include "event_poller.h"
+#include "expect_script.h"
 #include "file_descriptor.h"
 #include "history_reader.h"
 #include "history_writer.h"
+#include "input_source.h"
+#include "latency_recorder.h"
 #include "read_key.h"
-#include "resize_file.h"
+#include "realtime_profile.h"
+#include "receive_thread.h"
+#include "session_logger.h"
+#include "session_stats.h"
 #include "signal_settings.h"
+#include "splice_forwarder.h"
 #include "terminal_interface.h"
+#include "trigger_table.h"
+#include "tx_pacer.h"
+#include "write_all.h"
 
 namespace {
 
 using status_t = common::status_t;
 
 volatile sig_atomic_t g_should_continue = 1;
+// Set by SIGUSR1
+volatile sig_atomic_t g_should_dump_stats = 0;
 
 constexpr const char kHistoryFileName[] = ".stermcom_history";
-constexpr const auto kMaxHistoryLine    = 100;
+constexpr const size_t kDefaultHistorySize = 100;
+// Ended lines are appended to the history file at most this late
+constexpr const uint64_t kDefaultHistorySyncNs = 1000000000;
+
+constexpr const size_t kDefaultTxBufferSize = 64 * 1024;
+constexpr const size_t kStdinChunkSize      = 4096;
+// Room left for typed keys while piped input fills the outbound buffer
+constexpr const size_t kTxKeyReserve        = kStdinChunkSize;
+// Upper bound of bytes received from the device per wakeup
+constexpr const size_t kRxChunkSize         = 64 * 1024;
+constexpr const size_t kDefaultRxBufferSize = 1024 * 1024;
+// How long an incomplete key sequence waits for the rest of it
+constexpr const uint64_t kKeySequenceTimeoutNs = 50ULL * 1000000;
+// The response to a command has ended when the device is quiet this long
+constexpr const uint64_t kResponseQuietNs = 200ULL * 1000000;
+
+constexpr const uint64_t kDefaultExpectTimeoutNs = 10ULL * 1000000000;
+// Exit status when the device has not answered a script step in time
+constexpr const int kExitTimeout = 2;
+
+enum : int32_t {
+  kOptionTxBuffer = 0x100,
+  kOptionRxBuffer,
+  kOptionNoSplice,
+  kOptionRate,
+  kOptionCharDelay,
+  kOptionLineDelay,
+  kOptionExpectTimeout,
+  kOptionLogTx,
+  kOptionLogMaxSize,
+  kOptionLogRotateInterval,
+  kOptionLogKeep,
+  kOptionLogFsync,
+  kOptionStats,
+  kOptionStatsFile,
+  kOptionRtPriority,
+  kOptionCpu,
+  kOptionHistorySize,
+  kOptionHistorySync,
+};
+
+const struct option kLongOptions[] = {
+  {"tx-buffer",           required_argument, nullptr, kOptionTxBuffer         },
+  {"rx-thread",           no_argument,       nullptr, 'T'                     },
+  {"rx-buffer",           required_argument, nullptr, kOptionRxBuffer         },
+  {"no-splice",           no_argument,       nullptr, kOptionNoSplice         },
+  {"flow",                required_argument, nullptr, 'f'                     },
+  {"rate",                required_argument, nullptr, kOptionRate             },
+  {"char-delay",          required_argument, nullptr, kOptionCharDelay        },
+  {"line-delay",          required_argument, nullptr, kOptionLineDelay        },
+  {"expect",              required_argument, nullptr, 'e'                     },
+  {"expect-timeout",      required_argument, nullptr, kOptionExpectTimeout    },
+  {"triggers",            required_argument, nullptr, 't'                     },
+  {"log",                 required_argument, nullptr, 'l'                     },
+  {"log-tx",              no_argument,       nullptr, kOptionLogTx            },
+  {"log-max-size",        required_argument, nullptr, kOptionLogMaxSize       },
+  {"log-rotate-interval", required_argument, nullptr, kOptionLogRotateInterval},
+  {"log-keep",            required_argument, nullptr, kOptionLogKeep          },
+  {"log-fsync",           required_argument, nullptr, kOptionLogFsync         },
+  {"capture",             required_argument, nullptr, 'c'                     },
+  {"stats",               no_argument,       nullptr, kOptionStats            },
+  {"stats-file",          required_argument, nullptr, kOptionStatsFile        },
+  {"low-latency",         no_argument,       nullptr, 'L'                     },
+  {"rt-priority",         required_argument, nullptr, kOptionRtPriority       },
+  {"cpu",                 required_argument, nullptr, kOptionCpu              },
+  {"history-size",        required_argument, nullptr, kOptionHistorySize      },
+  {"history-sync",        required_argument, nullptr, kOptionHistorySync      },
+  {nullptr,               0,                 nullptr, 0                       },
+};
 
 struct Options {
   std::string path_to_program;
   uint32_t baud_rate;
   std::string path_to_device_node;
   bool use_external_history;
+  size_t history_size;
+  util::history_sync_t history_sync_policy;
+  uint64_t history_sync_interval_ns;
+  size_t tx_buffer_size;
+  bool use_rx_thread;
+  size_t rx_buffer_size;
+  bool use_splice;
+  util::flow_control_t flow_control;
+  util::TxPacer::Settings pacing;
+  std::string expect_prompt;
+  uint64_t expect_timeout_ns;
+  std::string path_to_triggers;
+  util::SessionLogger::Settings log;
+  bool use_tx_log;
+  std::string path_to_capture;
+  bool show_stats;
+  std::string path_to_stats_file;
+  bool use_low_latency;
+  util::RealtimeProfile::Settings realtime;
 
   Options()
     : path_to_program(),
       baud_rate(9600),
       path_to_device_node(),
-      use_external_history(false) {}
+      use_external_history(false),
+      history_size(kDefaultHistorySize),
+      history_sync_policy(util::history_sync_t::kPeriodic),
+      history_sync_interval_ns(kDefaultHistorySyncNs),
+      tx_buffer_size(kDefaultTxBufferSize),
+      use_rx_thread(false),
+      rx_buffer_size(kDefaultRxBufferSize),
+      use_splice(true),
+      flow_control(util::flow_control_t::kNone),
+      pacing(),
+      expect_prompt(),
+      expect_timeout_ns(kDefaultExpectTimeoutNs),
+      path_to_triggers(),
+      log(),
+      use_tx_log(false),
+      path_to_capture(),
+      show_stats(false),
+      path_to_stats_file(),
+      use_low_latency(false),
+      realtime() {}
 };
 
 struct ParsingResult {
@@ -58,6 +184,99 @@ struct ParsingResult {
     : is_success(false), opts() {}
 };
 
+bool parseFlowControl(const std::string &str, util::flow_control_t *flow) {
+  if (str == "none") {
+    *flow = util::flow_control_t::kNone;
+  } else if (str == "rtscts") {
+    *flow = util::flow_control_t::kHardware;
+  } else if (str == "xonxoff") {
+    *flow = util::flow_control_t::kSoftware;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+// Accepts a plain number of bytes or one with a k/M/G suffix
+bool parseSize(const char *str, size_t *size) {
+  char *end = nullptr;
+  errno = 0;
+  auto value = std::strtoull(str, &end, 10);
+  if (errno != 0 || end == str) return false;
+
+  switch (*end) {
+    case '\0': break;
+    case 'k': case 'K': value <<= 10; ++end; break;
+    case 'm': case 'M': value <<= 20; ++end; break;
+    case 'g': case 'G': value <<= 30; ++end; break;
+    default: return false;
+  }
+  if (*end != '\0') return false;
+
+  *size = value;
+  return true;
+}
+
+// Accepts a number of milliseconds, or one with a us/ms/s/min/h suffix
+bool parseDelay(const char *str, uint64_t *delay_ns) {
+  char *end = nullptr;
+  errno = 0;
+  auto value = std::strtod(str, &end);
+  if (errno != 0 || end == str || value < 0) return false;
+
+  const std::string unit(end);
+  if (unit.empty() || unit == "ms") {
+    value *= 1e6;
+  } else if (unit == "us") {
+    value *= 1e3;
+  } else if (unit == "s") {
+    value *= 1e9;
+  } else if (unit == "min") {
+    value *= 60e9;
+  } else if (unit == "h") {
+    value *= 3600e9;
+  } else {
+    return false;
+  }
+
+  *delay_ns = static_cast<uint64_t>(value);
+  return true;
+}
+
+// "never", "rotate", "always" or an interval
+bool parseFsyncPolicy(const char *str, util::SessionLogger::Settings *log) {
+  const std::string policy(str);
+  if (policy == "never") {
+    log->fsync_policy = util::fsync_policy_t::kNever;
+  } else if (policy == "rotate") {
+    log->fsync_policy = util::fsync_policy_t::kOnRotate;
+  } else if (policy == "always") {
+    log->fsync_policy = util::fsync_policy_t::kEveryWrite;
+  } else if (parseDelay(str, &log->fsync_interval_ns)) {
+    log->fsync_policy = util::fsync_policy_t::kPeriodic;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+// "exit", "always", "sync" or an interval
+bool parseHistorySyncPolicy(const char *str, Options *opts) {
+  const std::string policy(str);
+  if (policy == "exit") {
+    opts->history_sync_policy = util::history_sync_t::kOnExit;
+  } else if (policy == "always") {
+    opts->history_sync_policy = util::history_sync_t::kEveryLine;
+  } else if (policy == "sync") {
+    opts->history_sync_policy = util::history_sync_t::kEveryLineSync;
+  } else if (parseDelay(str, &opts->history_sync_interval_ns)) {
+    opts->history_sync_policy = util::history_sync_t::kPeriodic;
+  } else {
+    return false;
+  }
+  return true;
+}
+
 ParsingResult parseOptions(int argc, char *argv[]) {
   ParsingResult result;
   opterr = 0;
@@ -65,11 +284,17 @@ ParsingResult parseOptions(int argc, char *argv[]) {
   result.opts.path_to_program = std::string(argv[0]);
 
   int opt_char;
-  while ((opt_char = getopt(argc, argv, "b:h")) != -1) {
+  while ((opt_char = getopt_long(argc, argv, "b:c:e:f:hl:Lt:T", kLongOptions, nullptr)) !=
+         -1) {
     switch (opt_char) {
       case 'b': {
         try {
-          result.opts.baud_rate = std::stoi(optarg);
+          auto baud_rate = std::stoul(optarg);
+          if (baud_rate > UINT32_MAX) {
+            DEBUG_PRINTF("incorrect baud_rate");
+            return result;
+          }
+          result.opts.baud_rate = baud_rate;
         }
         catch (...) {
           DEBUG_PRINTF("incorrect baud_rate");
@@ -81,6 +306,183 @@ ParsingResult parseOptions(int argc, char *argv[]) {
         result.opts.use_external_history = true;
         break;
       }
+      case kOptionHistorySize: {
+        if (!parseSize(optarg, &result.opts.history_size) ||
+            result.opts.history_size == 0) {
+          DEBUG_PRINTF("incorrect history-size");
+          return result;
+        }
+        break;
+      }
+      case kOptionHistorySync: {
+        if (!parseHistorySyncPolicy(optarg, &result.opts)) {
+          DEBUG_PRINTF("incorrect history-sync");
+          return result;
+        }
+        break;
+      }
+      case kOptionTxBuffer: {
+        if (!parseSize(optarg, &result.opts.tx_buffer_size) ||
+            result.opts.tx_buffer_size <= kTxKeyReserve) {
+          DEBUG_PRINTF("incorrect tx-buffer");
+          return result;
+        }
+        break;
+      }
+      case 'T': {
+        result.opts.use_rx_thread = true;
+        break;
+      }
+      case kOptionRxBuffer: {
+        if (!parseSize(optarg, &result.opts.rx_buffer_size) ||
+            result.opts.rx_buffer_size == 0) {
+          DEBUG_PRINTF("incorrect rx-buffer");
+          return result;
+        }
+        break;
+      }
+      case kOptionNoSplice: {
+        result.opts.use_splice = false;
+        break;
+      }
+      case 'f': {
+        if (!parseFlowControl(optarg, &result.opts.flow_control)) {
+          DEBUG_PRINTF("incorrect flow control");
+          return result;
+        }
+        break;
+      }
+      case kOptionRate: {
+        size_t rate;
+        if (!parseSize(optarg, &rate)) {
+          DEBUG_PRINTF("incorrect rate");
+          return result;
+        }
+        result.opts.pacing.bytes_per_sec = rate;
+        break;
+      }
+      case kOptionCharDelay: {
+        if (!parseDelay(optarg, &result.opts.pacing.char_delay_ns)) {
+          DEBUG_PRINTF("incorrect char-delay");
+          return result;
+        }
+        break;
+      }
+      case kOptionLineDelay: {
+        if (!parseDelay(optarg, &result.opts.pacing.line_delay_ns)) {
+          DEBUG_PRINTF("incorrect line-delay");
+          return result;
+        }
+        break;
+      }
+      case 'e': {
+        result.opts.expect_prompt = std::string(optarg);
+        if (result.opts.expect_prompt.empty()) {
+          DEBUG_PRINTF("empty prompt");
+          return result;
+        }
+        break;
+      }
+      case 't': {
+        result.opts.path_to_triggers = std::string(optarg);
+        break;
+      }
+      case 'c': {
+        result.opts.path_to_capture = std::string(optarg);
+        break;
+      }
+      case 'l': {
+        result.opts.log.path = std::string(optarg);
+        break;
+      }
+      case 'L': {
+        result.opts.use_low_latency = true;
+        result.opts.realtime.lock_memory = true;
+        break;
+      }
+      case kOptionRtPriority: {
+        try {
+          auto priority = std::stoul(optarg);
+          if (priority < 1 || priority > 99) {
+            DEBUG_PRINTF("incorrect rt-priority");
+            return result;
+          }
+          result.opts.realtime.priority = priority;
+        }
+        catch (...) {
+          DEBUG_PRINTF("incorrect rt-priority");
+          return result;
+        }
+        break;
+      }
+      case kOptionCpu: {
+        try {
+          auto cpu = std::stoul(optarg);
+          if (cpu > INT32_MAX) {
+            DEBUG_PRINTF("incorrect cpu");
+            return result;
+          }
+          result.opts.realtime.cpu = cpu;
+        }
+        catch (...) {
+          DEBUG_PRINTF("incorrect cpu");
+          return result;
+        }
+        break;
+      }
+      case kOptionStats: {
+        result.opts.show_stats = true;
+        break;
+      }
+      case kOptionStatsFile: {
+        result.opts.path_to_stats_file = std::string(optarg);
+        break;
+      }
+      case kOptionLogTx: {
+        result.opts.use_tx_log = true;
+        break;
+      }
+      case kOptionLogMaxSize: {
+        size_t max_size;
+        if (!parseSize(optarg, &max_size)) {
+          DEBUG_PRINTF("incorrect log-max-size");
+          return result;
+        }
+        result.opts.log.max_size = max_size;
+        break;
+      }
+      case kOptionLogRotateInterval: {
+        if (!parseDelay(optarg, &result.opts.log.rotate_interval_ns)) {
+          DEBUG_PRINTF("incorrect log-rotate-interval");
+          return result;
+        }
+        break;
+      }
+      case kOptionLogKeep: {
+        try {
+          result.opts.log.keep = std::stoul(optarg);
+        }
+        catch (...) {
+          DEBUG_PRINTF("incorrect log-keep");
+          return result;
+        }
+        break;
+      }
+      case kOptionLogFsync: {
+        if (!parseFsyncPolicy(optarg, &result.opts.log)) {
+          DEBUG_PRINTF("incorrect log-fsync");
+          return result;
+        }
+        break;
+      }
+      case kOptionExpectTimeout: {
+        if (!parseDelay(optarg, &result.opts.expect_timeout_ns) ||
+            result.opts.expect_timeout_ns == 0) {
+          DEBUG_PRINTF("incorrect expect-timeout");
+          return result;
+        }
+        break;
+      }
       default: {
         DEBUG_PRINTF("unknown option");
         return result;
@@ -99,14 +501,10 @@ ParsingResult parseOptions(int argc, char *argv[]) {
   return result;
 }
 
-status_t setStdinToNonblock() {
-  auto flags = fcntl(STDIN_FILENO, F_GETFL, 0);
-  if (flags == -1) return status_t::kFailure;
-
-  auto ret = fcntl(STDIN_FILENO, F_SETFL, flags | O_NONBLOCK);
-  if (ret == -1) return status_t::kFailure;
-
-  return status_t::kSuccess;
+uint64_t nowNs() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return static_cast<uint64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
 }
 
 status_t reopenStdin() {
@@ -120,10 +518,66 @@ status_t reopenStdin() {
   return status_t::kSuccess;
 }
 
+// Moves piped or redirected input into the outbound buffer while keeping
+// room for typed keys
+void fillFromInput(util::InputSource &input, util::ByteRingBuffer &buffer) {
+  if (buffer.Free() <= kTxKeyReserve) return;
+  (void)input.Fill(buffer, buffer.Free() - kTxKeyReserve);
+}
+
+// Asks the local terminal to enclose pasted text in ESC [ 200 ~ and
+// ESC [ 201 ~ for as long as the object lives
+class BracketedPasteMode final {
+ public:
+  BracketedPasteMode() : is_enabled_(isatty(STDOUT_FILENO)) {
+    if (is_enabled_) (void)util::WriteAll(STDOUT_FILENO, kEnable, 8);
+  }
+  ~BracketedPasteMode() {
+    if (is_enabled_) (void)util::WriteAll(STDOUT_FILENO, kDisable, 8);
+  }
+
+ private:
+  static constexpr const uint8_t kEnable[]  = "\x1b[?2004h";
+  static constexpr const uint8_t kDisable[] = "\x1b[?2004l";
+
+  bool is_enabled_;
+};
+
+constexpr const uint8_t BracketedPasteMode::kEnable[];
+constexpr const uint8_t BracketedPasteMode::kDisable[];
+
+void pushBytes(util::ByteRingBuffer &buffer, const util::ByteView &bytes) {
+  if (buffer.Push(bytes.data, bytes.size) != bytes.size)
+    DEBUG_PRINTF("The outbound buffer is full");
+}
+
+void pushBytes(util::ByteRingBuffer &buffer, const util::ByteRun &run) {
+  uint8_t chunk[64];
+  std::memset(chunk, run.byte, sizeof(chunk));
+  for (size_t pushed = 0; pushed < run.count;) {
+    auto size = std::min(sizeof(chunk), run.count - pushed);
+    if (buffer.Push(chunk, size) != size) {
+      DEBUG_PRINTF("The outbound buffer is full");
+      break;
+    }
+    pushed += size;
+  }
+}
+
+// Bytes which are typed into the reverse search rather than sent
+bool isSearchText(const util::KeyEvent &event) {
+  if (event.key_type != util::key_t::kOther) return false;
+  for (auto c : event.bytes) {
+    if (c < 0x20 || c == 0x7f) return false;
+  }
+  return true;
+}
+
 status_t mainLoop(const int32_t &tty_fd, const Options &opts) {
-  fd_set fds_r, fds_w;
-  uint8_t one_char;
-  std::list<uint8_t> string_buffer{};
+  util::ByteRingBuffer string_buffer(opts.tx_buffer_size);
+  std::vector<uint8_t> tty_read_buffer(kRxChunkSize);
+  uint8_t stdin_read_buffer[kStdinChunkSize];
+  util::KeyDecoder key_decoder;
   ssize_t rw_size;
 
   std::string history_file_path;
@@ -135,19 +589,70 @@ status_t mainLoop(const int32_t &tty_fd, const Options &opts) {
       return status_t::kFailure;
     }
   }
-  util::HistoryWriter history_writer(history_file_path);
-  util::HistoryReader history_reader(history_file_path);
-
-  // Support piping and redirection
-  if (setStdinToNonblock() == status_t::kFailure) return status_t::kFailure;
-  while (true) {
-    rw_size = read(STDIN_FILENO, &one_char, 1);
-    if (rw_size > 0) {
-      string_buffer.push_back(one_char);
-    } else {
-      break;
+  util::HistoryWriter history_writer(history_file_path, opts.history_size,
+                                     opts.history_sync_policy,
+                                     opts.history_sync_interval_ns);
+  util::HistoryReader history_reader(history_file_path, opts.history_size);
+  util::SessionStats stats;
+  util::LatencyRecorder latency(kResponseQuietNs);
+  // When the keys being handled were read
+  uint64_t key_read_ns = 0;
+  // When an incomplete key sequence is given up and decoded as it is
+  uint64_t key_deadline_ns = 0;
+
+  // Patterns of all triggers are searched for in one pass
+  util::TriggerTable triggers;
+  std::unique_ptr<util::AhoCorasick> trigger_matcher;
+  if (!opts.path_to_triggers.empty()) {
+    if (triggers.Load(opts.path_to_triggers) == status_t::kFailure) {
+      printf("%s\n", triggers.Error().c_str());
+      return status_t::kFailure;
+    }
+    trigger_matcher.reset(new util::AhoCorasick(triggers.Patterns()));
+    DEBUG_PRINTF("%zu triggers, %zu states", triggers.Triggers().size(),
+                 trigger_matcher->StateCount());
+  }
+
+  // The transcript is written on a separate thread
+  std::unique_ptr<util::SessionLogger> logger;
+  if (!opts.log.path.empty()) {
+    logger.reset(new util::SessionLogger(opts.log));
+    if (logger->Start() == status_t::kFailure) {
+      printf("cannot open the log file %s\n", opts.log.path.c_str());
+      return status_t::kFailure;
+    }
+  }
+
+  // Both directions are recorded with their timing
+  std::unique_ptr<util::CaptureWriter> capture;
+  if (!opts.path_to_capture.empty()) {
+    capture.reset(new util::CaptureWriter(opts.path_to_capture));
+    if (capture->Open() == status_t::kFailure) {
+      printf("cannot create the capture file %s\n",
+             opts.path_to_capture.c_str());
+      return status_t::kFailure;
     }
   }
+
+  // Support piping and redirection. The input stays open next to /dev/tty
+  // and is streamed to the device as it drains the outbound buffer.
+  util::InputSource input(dup(STDIN_FILENO));
+  if (input.Open() == status_t::kFailure) return status_t::kFailure;
+
+  // In the script mode the input is sent line by line
+  std::unique_ptr<util::ExpectScript> script;
+  if (!opts.expect_prompt.empty()) {
+    script.reset(new util::ExpectScript(
+        opts.expect_prompt, opts.expect_timeout_ns, opts.tx_buffer_size));
+  }
+  auto fill_input = [&]() -> void {
+    if (script) {
+      (void)input.Fill(script->Buffer(), script->Buffer().Free());
+    } else {
+      fillFromInput(input, string_buffer);
+    }
+  };
+  fill_input();
   if (reopenStdin() == status_t::kFailure) return status_t::kFailure;
 
   util::TerminalInterface stdin_term(STDIN_FILENO), tty_term(tty_fd);
@@ -161,128 +666,548 @@ status_t mainLoop(const int32_t &tty_fd, const Options &opts) {
     return status_t::kFailure;
   if (tty_term.SetBaudRate(0, util::direction_t::kIn) == status_t::kFailure)
     return status_t::kFailure;
+  if (tty_term.SetFlowControl(opts.flow_control) == status_t::kFailure)
+    return status_t::kFailure;
+  // Not every driver has a low latency mode; the rest of it still applies
+  auto is_low_latency_supported =
+      !opts.use_low_latency ||
+      tty_term.SetLowLatency() == status_t::kSuccess;
 
   if (stdin_term.SetNow() == status_t::kFailure)
     return status_t::kFailure;
-  if (tty_term.SetNow() == status_t::kFailure)
+  if (tty_term.SetNow() == status_t::kFailure) {
+    printf("cannot set the baud rate %u\r\n", opts.baud_rate);
     return status_t::kFailure;
+  }
 
-  assert(tty_fd > STDIN_FILENO && "Assertion for select()");
+  // Drivers round to the nearest rate their clock can generate
+  uint32_t applied_baud_rate;
+  if (tty_term.GetBaudRate(&applied_baud_rate) == status_t::kSuccess &&
+      applied_baud_rate != opts.baud_rate)
+    printf("The baud rate is %u (requested: %u)\r\n", applied_baud_rate,
+           opts.baud_rate);
+  if (!is_low_latency_supported)
+    printf("The driver has no low latency mode\r\n");
+
+  util::EventPoller poller;
+  if (poller.Add(STDIN_FILENO, util::EventPoller::kReadable) ==
+      status_t::kFailure)
+    return status_t::kFailure;
+
+  // In the threaded mode only the receive thread reads from the device
+  std::unique_ptr<util::ReceiveThread> receiver;
+  uint32_t tty_read_interest = util::EventPoller::kReadable;
+  if (opts.use_rx_thread)
+    receiver.reset(new util::ReceiveThread(tty_fd, opts.rx_buffer_size));
+
+  // Applied once the buffers of the I/O path exist, so that they are
+  // locked, and before the receive thread starts, so that it inherits the
+  // scheduling
+  util::RealtimeProfile realtime(opts.realtime);
+  if (realtime.Apply() == status_t::kFailure)
+    printf("%s\r\n", realtime.Error().c_str());
+  // A redirected file is read once, and need not stay resident
+  if (opts.realtime.lock_memory) input.Unlock();
+
+  if (receiver) {
+    if (receiver->Start() == status_t::kFailure) return status_t::kFailure;
+    if (poller.Add(receiver->NotifyFd(), util::EventPoller::kReadable) ==
+        status_t::kFailure)
+      return status_t::kFailure;
+    tty_read_interest = 0;
+  }
+  if (poller.Add(tty_fd, tty_read_interest) == status_t::kFailure)
+    return status_t::kFailure;
+
+  // Inputs which cannot be waited on (e.g. mapped or regular files) are
+  // refilled whenever the device has taken data
+  auto input_fd = input.IsExhausted() ? -1 : input.PollFd();
+  if (input_fd != -1 &&
+      poller.Add(input_fd, util::EventPoller::kReadable) == status_t::kFailure)
+    input_fd = -1;
+  auto is_input_polled = input_fd != -1;
+  if (input.IsExhausted()) input.Close();
+
+  // When stdout is a pipe or a file, received data is spliced to it
+  // without a copy through userspace, unless it has to be scanned
+  std::unique_ptr<util::SpliceForwarder> splicer;
+  if (opts.use_splice && !receiver && !script && !trigger_matcher &&
+      !logger && !capture) {
+    splicer.reset(new util::SpliceForwarder(STDOUT_FILENO));
+    if (splicer->Open() == status_t::kFailure) splicer.reset();
+  }
+
+  // Without pacing the device is written whenever it is writable
+  std::unique_ptr<util::TxPacer> pacer(new util::TxPacer(opts.pacing));
+  if (!pacer->IsEnabled()) {
+    pacer.reset();
+  } else if (pacer->Open() == status_t::kFailure ||
+             poller.Add(pacer->TimerFd(), util::EventPoller::kReadable) ==
+                 status_t::kFailure) {
+    return status_t::kFailure;
+  }
+
+  // Script steps and marks are reported to stderr, as stdout carries the
+  // session
+  const char *report_eol = isatty(STDERR_FILENO) ? "\r\n" : "\n";
+  auto format_stats = [&](const char *eol) -> std::string {
+    if (receiver)
+      stats.SetThreadReceive(receiver->ReadCalls(), receiver->ReadBytes(),
+                             receiver->OverflowBytes());
+    latency.Settle(nowNs());
+    return stats.Format(tty_fd, eol) + latency.Format(eol);
+  };
+  // Without a stats file the statistics go to stderr
+  auto dump_stats = [&]() -> void {
+    if (opts.path_to_stats_file.empty()) {
+      fputs(format_stats(report_eol).c_str(), stderr);
+    } else if (util::SessionStats::WriteFile(opts.path_to_stats_file,
+                                             format_stats("\n")) ==
+               status_t::kFailure) {
+      DEBUG_PRINTF("Fail to write the stats file");
+    }
+  };
+  auto report_step = [&](const char *result) -> void {
+    fprintf(stderr, "step %u %s %.3f ms: %s%s", script->Step(), result,
+            script->ElapsedNs() / 1e6, script->Line().c_str(), report_eol);
+  };
+
+  auto fire_trigger = [&](uint32_t index) -> void {
+    const auto &trigger = triggers.Triggers()[index];
+    if (trigger.action == util::trigger_action_t::kSend) {
+      auto size = string_buffer.Push(
+          reinterpret_cast<const uint8_t *>(trigger.text.data()),
+          trigger.text.size());
+      if (size != trigger.text.size())
+        DEBUG_PRINTF("The outbound buffer is full");
+    } else {
+      fprintf(stderr, "mark: %s%s", trigger.text.c_str(), report_eol);
+    }
+  };
+
+  auto forward_received = [&](const uint8_t *data, size_t size) -> void {
+    if (util::WriteAll(STDOUT_FILENO, data, size) == status_t::kFailure)
+      DEBUG_PRINTF("Fail to write to stdout");
+    if (capture)
+      capture->Record(util::capture_direction_t::kReceived, data, size);
+    latency.Received(nowNs());
+    if (logger) logger->Log(data, size);
+    if (trigger_matcher) trigger_matcher->Scan(data, size, fire_trigger);
+    if (script && script->Feed(data, size)) report_step("ok");
+  };
+
+  // Returns the result of writev()
+  auto send_buffered = [&]() -> ssize_t {
+    // The storage may wrap around, so the bytes to be sent are two regions.
+    // They stay readable until the next Push().
+    const uint8_t *front = nullptr, *wrapped = nullptr;
+    auto front_size   = string_buffer.Peek(&front);
+    auto wrapped_size = string_buffer.Peek(&wrapped, front_size);
+
+    auto ret = pacer ? pacer->WriteTo(string_buffer, tty_fd)
+                     : string_buffer.WriteTo(tty_fd);
+    // The pacer holds bytes back on purpose, which is no short write
+    stats.CountSend(pacer && ret > 0 ? ret : front_size + wrapped_size, ret);
+    if (ret <= 0) return ret;
+
+    auto size = static_cast<size_t>(ret);
+    latency.Sent(nowNs(), size);
+    auto record = [&](const uint8_t *data, size_t data_size) -> void {
+      if (capture)
+        capture->Record(util::capture_direction_t::kSent, data, data_size);
+      if (logger && opts.use_tx_log) logger->Log(data, data_size);
+    };
+    record(front, std::min(size, front_size));
+    if (size > front_size)
+      record(wrapped, std::min(size - front_size, wrapped_size));
+    return ret;
+  };
+
+  BracketedPasteMode bracketed_paste_mode;
+  // Pasted text is added to the history line only while it has no newline
+  bool is_paste_recorded = false;
+
+  // Returns false when the session should end
+  auto handle_keys =
+      [&](const std::vector<util::KeyEvent> &key_events) -> bool {
+    for (const auto &event : key_events) {
+      if (event.key_type == util::key_t::kCtrlX) return false;
+
+      // Pasted text is sent in bulk and skips the per-key handling
+      if (event.key_type == util::key_t::kPasteBegin) {
+        if (opts.use_external_history) {
+          history_writer.AddStr(history_reader.At());
+          history_reader.EndSearch();
+          is_paste_recorded = true;
+        }
+        continue;
+      }
+      if (event.key_type == util::key_t::kPasteEnd) {
+        is_paste_recorded = false;
+        continue;
+      }
+      if (event.key_type == util::key_t::kPaste) {
+        string_buffer.Push(event.bytes.data, event.bytes.size);
+        if (is_paste_recorded) {
+          if (std::memchr(event.bytes.data, '\r', event.bytes.size) ||
+              std::memchr(event.bytes.data, '\n', event.bytes.size)) {
+            // Several lines are no single history entry
+            history_writer.Clear();
+            is_paste_recorded = false;
+          } else {
+            history_writer.AddStr(event.bytes);
+          }
+        }
+        continue;
+      }
+
+      if (event.key_type == util::key_t::kEnter)
+        latency.CommandEntered(key_read_ns);
+      if (!opts.use_external_history) {
+        string_buffer.Push(event.bytes.data, event.bytes.size);
+        continue;
+      }
+      // During the reverse search the selected line replaces the line on
+      // the device as the search text is typed. Other keys end the search
+      // and are handled as usual.
+      if (history_reader.IsReverseSearching() &&
+          (event.key_type == util::key_t::kCtrlR ||
+           event.key_type == util::key_t::kDel ||
+           event.key_type == util::key_t::kEsc || isSearchText(event))) {
+        auto selected = history_reader.At();
+        auto clear = history_reader.ClearHistoryLine();
+        if (event.key_type == util::key_t::kEsc) {
+          DEBUG_PRINTF("KEY: ESC (cancel the search)");
+          pushBytes(string_buffer, clear);
+          history_reader.EndSearch();
+          continue;
+        }
+        if (event.key_type == util::key_t::kCtrlR) {
+          history_reader.SearchOlder();
+        } else if (event.key_type == util::key_t::kDel) {
+          history_reader.RemoveSearchByte();
+        } else {
+          history_reader.AddSearchBytes(event.bytes);
+        }
+        if (history_reader.At().data != selected.data) {
+          pushBytes(string_buffer, clear);
+          pushBytes(string_buffer, history_reader.At());
+        }
+        if (history_reader.IsSearchFailing()) {
+          static constexpr const uint8_t kBell[] = "\a";
+          (void)util::WriteAll(STDOUT_FILENO, kBell, 1);
+        }
+        continue;
+      }
+
+      switch (event.key_type) {
+        case util::key_t::kCtrlR: {
+          DEBUG_PRINTF("KEY: CtrlR");
+          // The lines of this session are searched as well
+          (void)history_writer.Flush();
+          history_reader.StartReverseSearch();
+          break;
+        }
+        case util::key_t::kUp: {
+          DEBUG_PRINTF("KEY: UP");
+          (void)history_writer.Flush();
+          history_reader.StartSearch();
+          pushBytes(string_buffer, history_reader.ClearHistoryLine());
+          history_reader.Up();
+          pushBytes(string_buffer, history_reader.At());
+          break;
+        }
+        case util::key_t::kDown: {
+          DEBUG_PRINTF("KEY: DOWN");
+          pushBytes(string_buffer, history_reader.ClearHistoryLine());
+          history_reader.Down();
+          pushBytes(string_buffer, history_reader.At());
+          break;
+        }
+        case util::key_t::kRight: {
+          DEBUG_PRINTF("KEY: RIGHT");
+          pushBytes(string_buffer, history_reader.ClearHistoryLine());
+          history_reader.EndSearch();
+          break;
+        }
+        case util::key_t::kLeft: {
+          DEBUG_PRINTF("KEY: LEFT");
+          pushBytes(string_buffer, history_reader.ClearHistoryLine());
+          history_reader.EndSearch();
+          break;
+        }
+        case util::key_t::kEnter: {
+          DEBUG_PRINTF("KEY: ENTER");
+          history_writer.AddStr(history_reader.At());
+          history_reader.EndSearch();
+          history_writer.Write();
+          string_buffer.Push(event.bytes.data, event.bytes.size);
+          break;
+        }
+        case util::key_t::kDel: {
+          DEBUG_PRINTF("KEY: DEL");
+          history_writer.AddStr(history_reader.At());
+          history_reader.EndSearch();
+          history_writer.PopBack();
+          string_buffer.Push(event.bytes.data, event.bytes.size);
+          break;
+        }
+        case util::key_t::kEsc: {
+          DEBUG_PRINTF("KEY: ESC");
+          string_buffer.Push(event.bytes.data, event.bytes.size);
+          break;
+        }
+        default: {
+          history_writer.AddStr(history_reader.At());
+          history_reader.EndSearch();
+          history_writer.AddStr(event.bytes);
+          string_buffer.Push(event.bytes.data, event.bytes.size);
+          break;
+        }
+      }
+    }
+    return true;
+  };
+
+  util::PollEvent events[util::EventPoller::kMaxEvents];
+  auto result = status_t::kSuccess;
+  // Received bytes which are still in the ring after a wakeup
+  bool is_rx_pending = false;
 
   while (g_should_continue) {
-    FD_ZERO(&fds_r);
-    FD_ZERO(&fds_r);
+    // The wait is interrupted by SIGUSR1, so the stats are dumped here
+    if (g_should_dump_stats) {
+      g_should_dump_stats = 0;
+      dump_stats();
+    }
+    stats.CountQueueDepth(string_buffer.Size());
 
-    FD_SET(STDIN_FILENO, &fds_r);
-    FD_SET(tty_fd, &fds_r);
-    FD_SET(tty_fd, &fds_w);
+    // The next line is sent once the previous one has been answered
+    if (script && script->Advance(string_buffer, input.IsExhausted())) {
+      DEBUG_PRINTF("The script is complete");
+      break;
+    }
+
+    // A tty is almost always writable, so the write interest is armed only
+    // while there is something to send. Otherwise the loop never sleeps.
+    auto tty_interest = tty_read_interest;
+    // While the pacer holds the data back, its timer is waited for instead
+    if (!string_buffer.Empty() && (!pacer || pacer->IsReady(string_buffer)))
+      tty_interest |= util::EventPoller::kWritable;
+    if (poller.Modify(tty_fd, tty_interest) == status_t::kFailure) {
+      printf("Error\n");
+      return status_t::kFailure;
+    }
+    // Keys are read only when a whole chunk of them fits, so that nothing
+    // typed or pasted is dropped
+    auto stdin_interest = string_buffer.Free() >= kStdinChunkSize
+                              ? util::EventPoller::kReadable
+                              : 0;
+    if (poller.Modify(STDIN_FILENO, stdin_interest) == status_t::kFailure) {
+      printf("Error\n");
+      return status_t::kFailure;
+    }
+    // Backpressure: the input is only waited on while there is room for
+    // it. A hang-up is reported even without interest, so the input is
+    // taken out of the poller rather than left in it with none.
+    if (input_fd != -1) {
+      auto has_room = script ? script->Buffer().Free() > 0
+                             : string_buffer.Free() > kTxKeyReserve;
+      if (has_room != is_input_polled) {
+        auto ret = has_room
+                       ? poller.Add(input_fd, util::EventPoller::kReadable)
+                       : poller.Remove(input_fd);
+        if (ret == status_t::kFailure) {
+          printf("Error\n");
+          return status_t::kFailure;
+        }
+        is_input_polled = has_room;
+      }
+    }
+
+    // A lone ESC is only known as such when nothing follows it in time
+    int32_t timeout_ms = -1;
+    if (key_decoder.HasPending()) {
+      auto now_ns = nowNs();
+      timeout_ms = now_ns >= key_deadline_ns
+                       ? 0
+                       : static_cast<int32_t>(
+                             (key_deadline_ns - now_ns + 999999) / 1000000);
+    }
+    if (script) {
+      auto script_timeout_ms = script->TimeoutMs();
+      if (script_timeout_ms >= 0 &&
+          (timeout_ms < 0 || script_timeout_ms < timeout_ms))
+        timeout_ms = script_timeout_ms;
+    }
+    auto history_timeout_ms = history_writer.TimeoutMs();
+    if (history_timeout_ms >= 0 &&
+        (timeout_ms < 0 || history_timeout_ms < timeout_ms))
+      timeout_ms = history_timeout_ms;
+    if (is_rx_pending) timeout_ms = 0;
 
     errno = 0;
-    auto ret = select(tty_fd + 1, &fds_r, &fds_w, nullptr, nullptr);
+    auto ret = poller.Wait(timeout_ms, events, util::EventPoller::kMaxEvents);
     if (ret == -1) {
       if (errno == EINTR) {
-        DEBUG_PRINTF("Signal was caught when select() is waiting");
-      } else {
-        printf("Error\n");
-        return status_t::kFailure;
+        DEBUG_PRINTF("Signal was caught when the poller is waiting");
+        continue;
       }
+      printf("Error\n");
+      return status_t::kFailure;
+    }
+    stats.CountWakeup();
+    if (history_writer.IsFlushDue()) (void)history_writer.Flush();
+    // Whatever else woke the loop up, so that a busy device cannot keep a
+    // lone ESC from being sent
+    if (key_decoder.HasPending() && nowNs() >= key_deadline_ns) {
+      key_read_ns = nowNs();
+      if (!handle_keys(key_decoder.Flush())) break;
+    }
+    if (script && script->IsTimedOut()) {
+      report_step("timeout");
+      result = status_t::kTimeout;
       break;
     }
 
-    if (FD_ISSET(STDIN_FILENO, &fds_r)) {
-      auto result = util::ReadKey(STDIN_FILENO);
-      if (result.key_type == util::key_t::kCtrlX) break;
-      if (opts.use_external_history) {
-        switch (result.key_type) {
-          case util::key_t::kCtrlR: {
-            DEBUG_PRINTF("KEY: CtrlR");
-            break;
-          }
-          case util::key_t::kUp: {
-            DEBUG_PRINTF("KEY: UP");
-            history_reader.StartSearch();
-            string_buffer.splice(string_buffer.end(), history_reader.ClearHistoryLine());
-            history_reader.Up();
-            string_buffer.splice(string_buffer.end(), history_reader.At());
-            break;
-          }
-          case util::key_t::kDown: {
-            DEBUG_PRINTF("KEY: DOWN");
-            string_buffer.splice(string_buffer.end(), history_reader.ClearHistoryLine());
-            history_reader.Down();
-            string_buffer.splice(string_buffer.end(), history_reader.At());
-            break;
-          }
-          case util::key_t::kRight: {
-            DEBUG_PRINTF("KEY: RIGHT");
-            string_buffer.splice(string_buffer.end(), history_reader.ClearHistoryLine());
-            history_reader.EndSearch();
-            break;
-          }
-          case util::key_t::kLeft: {
-            DEBUG_PRINTF("KEY: LEFT");
-            string_buffer.splice(string_buffer.end(), history_reader.ClearHistoryLine());
-            history_reader.EndSearch();
-            break;
-          }
-          case util::key_t::kEnter: {
-            DEBUG_PRINTF("KEY: ENTER");
-            history_writer.AddStr(history_reader.At());
-            history_reader.EndSearch();
-            history_writer.Write();
-            string_buffer.splice(string_buffer.end(), result.read_keys);
-            break;
-          }
-          case util::key_t::kDel: {
-            DEBUG_PRINTF("KEY: DEL");
-            history_writer.AddStr(history_reader.At());
-            history_reader.EndSearch();
-            history_writer.PopBack();
-            string_buffer.splice(string_buffer.end(), result.read_keys);
-            break;
-          }
-          case util::key_t::kEsc: {
-            DEBUG_PRINTF("KEY: ESC");
-            string_buffer.splice(string_buffer.end(), result.read_keys);
-            break;
-          }
-          default: {
-            history_writer.AddStr(history_reader.At());
-            history_reader.EndSearch();
-            history_writer.AddStr(result.read_keys);
-            string_buffer.splice(string_buffer.end(), result.read_keys);
-            break;
-          }
-        }
+    bool is_stdin_readable = false;
+    bool is_tty_readable   = false;
+    bool is_tty_writable   = false;
+    bool is_rx_notified    = false;
+    bool is_input_readable = false;
+    bool is_pacer_expired  = false;
+    for (int32_t i = 0; i < ret; ++i) {
+      // Errors and hang-ups are reported by the following read()
+      auto readable = util::EventPoller::kReadable | util::EventPoller::kError;
+      if (events[i].fd == STDIN_FILENO) {
+        if (events[i].events & readable) is_stdin_readable = true;
+      } else if (events[i].fd == tty_fd) {
+        if (!receiver && (events[i].events & readable)) is_tty_readable = true;
+        if (events[i].events & util::EventPoller::kWritable)
+          is_tty_writable = true;
+      } else if (receiver && events[i].fd == receiver->NotifyFd()) {
+        is_rx_notified = true;
+      } else if (pacer && events[i].fd == pacer->TimerFd()) {
+        is_pacer_expired = true;
+      } else if (events[i].fd == input_fd) {
+        // The end of a pipe is reported as a hang-up
+        is_input_readable = true;
+      }
+    }
+
+    if (is_stdin_readable) {
+      rw_size =
+          read(STDIN_FILENO, stdin_read_buffer, sizeof(stdin_read_buffer));
+      // The controlling terminal has gone away
+      if (rw_size == 0 ||
+          (rw_size == -1 && errno != EAGAIN && errno != EINTR))
+        break;
+      if (rw_size > 0) {
+        key_read_ns = nowNs();
+        auto queued_size = string_buffer.Size();
+        if (!handle_keys(key_decoder.Feed(stdin_read_buffer, rw_size)))
+          break;
+        if (key_decoder.HasPending())
+          key_deadline_ns = key_read_ns + kKeySequenceTimeoutNs;
+        if (string_buffer.Size() > queued_size)
+          latency.KeysQueued(key_read_ns, string_buffer.Size());
+      }
+    }
+    if (is_pacer_expired) pacer->Acknowledge();
+    if (is_tty_writable) {
+      // As many bytes as the kernel accepts; the rest stays buffered
+      rw_size = send_buffered();
+      if (rw_size > 0 && !input.IsExhausted() && input_fd == -1)
+        fill_input();
+    }
+    if (is_input_readable) {
+      fill_input();
+      if (input.IsExhausted()) {
+        if (is_input_polled) (void)poller.Remove(input_fd);
+        is_input_polled = false;
+        input.Close();
+        input_fd = -1;
+      }
+    }
+    if (is_tty_readable && splicer) {
+      rw_size = splicer->Forward(tty_fd, kRxChunkSize);
+      stats.CountReceive(rw_size);
+      if (rw_size == -1 && errno == EINVAL) {
+        DEBUG_PRINTF("splice() is not supported, copy instead");
+        splicer.reset();
       } else {
-        string_buffer.splice(string_buffer.end(), result.read_keys);
+        if (rw_size == 0 ||
+            (rw_size == -1 && errno != EAGAIN && errno != EINTR)) {
+          printf("The terminal is closed\n");
+          break;
+        }
+        if (rw_size > 0) latency.Received(nowNs());
+        is_tty_readable = false;
       }
     }
-    if (FD_ISSET(tty_fd, &fds_w)) {
-      if (!string_buffer.empty()) {
-        rw_size = write(tty_fd, &string_buffer.front(), 1);
-        if (rw_size > 0) string_buffer.pop_front();
+    if (is_tty_readable) {
+      rw_size = read(tty_fd, tty_read_buffer.data(), tty_read_buffer.size());
+      stats.CountReceive(rw_size);
+      if (rw_size == 0 ||
+          (rw_size == -1 && errno != EAGAIN && errno != EINTR)) {
+        printf("The terminal is closed\n");
+        break;
       }
+      if (rw_size > 0) forward_received(tty_read_buffer.data(), rw_size);
     }
-    if (FD_ISSET(tty_fd, &fds_r)) {
-      uint8_t tty_read_buffer;
-      rw_size = read(tty_fd, &tty_read_buffer, 1);
-      if (rw_size == 0) {
+    if (is_rx_notified || is_rx_pending) {
+      if (is_rx_notified) receiver->Acknowledge();
+      // Checked first, so that nothing received before closing is lost
+      auto is_closed = receiver->IsClosed();
+      // At most one chunk per wakeup. While a fast device keeps a slow
+      // stdout busy, keys and sending still get their turn.
+      const uint8_t *data;
+      auto size = std::min(receiver->Peek(&data), kRxChunkSize);
+      if (size > 0) {
+        forward_received(data, size);
+        receiver->Release(size);
+      }
+      is_rx_pending = receiver->Peek(&data) > 0;
+      if (is_closed && !is_rx_pending) {
         printf("The terminal is closed\n");
         break;
       }
-      if (rw_size > 0) write(STDOUT_FILENO, &tty_read_buffer, 1);
     }
   }
 
-  if (opts.use_external_history && util::FileExists(history_file_path)) {
-    if (util::ResizeFile(history_file_path, kMaxHistoryLine) ==
-        status_t::kFailure) {
-      printf("Fail to resize the history file\n");
+  if (receiver) {
+    receiver->Stop();
+    if (receiver->OverflowBytes() > 0) {
+      printf("%llu received bytes were dropped (receive buffer overflow)\n",
+             static_cast<unsigned long long>(receiver->OverflowBytes()));
     }
   }
 
-  return status_t::kSuccess;
+  if (capture) {
+    capture->Close();
+    if (capture->HasFailed()) printf("The capture is incomplete\n");
+  }
+
+  if (logger) {
+    logger->Stop();
+    if (logger->DroppedBytes() > 0) {
+      printf("%llu bytes were not logged (log buffer overflow)\n",
+             static_cast<unsigned long long>(logger->DroppedBytes()));
+    }
+    if (logger->UnloggedBytes() > 0) {
+      printf("%llu bytes were not logged (the log file could not be "
+             "written)\n",
+             static_cast<unsigned long long>(logger->UnloggedBytes()));
+    }
+  }
+
+  if (!opts.path_to_stats_file.empty() &&
+      util::SessionStats::WriteFile(opts.path_to_stats_file,
+                                    format_stats("\n")) == status_t::kFailure)
+    printf("Fail to write the stats file\n");
+  if (opts.show_stats) fputs(format_stats(report_eol).c_str(), stderr);
+
+  return result;
 }
 
 }  // namespace
@@ -294,7 +1219,19 @@ int main(int argc, char *argv[]) {
     // basename() may modify the contents of path, so it may be desirable to
     // pass a copy when calling the function.
     auto path_to_program = result.opts.path_to_program;
-    printf("USAGE: %s [-h] [-b baud_rate] device_node\n",
+    printf("USAGE: %s [-h] [--history-size=lines] "
+           "[--history-sync=exit|always|sync|time] [-T] [-b baud_rate] "
+           "[-f none|rtscts|xonxoff] "
+           "[--tx-buffer=size] "
+           "[--rate=bytes_per_sec] [--char-delay=time] [--line-delay=time] "
+           "[--rx-buffer=size] [--no-splice] "
+           "[-e prompt] [--expect-timeout=time] [-t trigger_file] "
+           "[-l log_file] [--log-tx] [--log-max-size=size] "
+           "[--log-rotate-interval=time] [--log-keep=count] "
+           "[--log-fsync=never|rotate|always|time] [-c capture_file] "
+           "[--stats] [--stats-file=file] "
+           "[-L] [--rt-priority=priority] [--cpu=cpu] "
+           "device_node\n",
            basename(const_cast<char *>(path_to_program.c_str())));
     return EXIT_FAILURE;
   }
@@ -324,8 +1261,11 @@ int main(int argc, char *argv[]) {
         SIG_IGN,
         // +: decay operator
         +[](int32_t) -> void {
-          // When signal is caught, select() is not always waiting.
+          // When signal is caught, the poller is not always waiting.
           g_should_continue = 0;
+        },
+        +[](int32_t) -> void {
+          g_should_dump_stats = 1;
         }
       ) == status_t::kFailure) return EXIT_FAILURE;
 #else
@@ -337,12 +1277,17 @@ int main(int argc, char *argv[]) {
         +[](int32_t) -> void {
           (void)write(STDOUT_FILENO, "Disconnect\n", 11);
           g_should_continue = 0;
+        },
+        +[](int32_t) -> void {
+          (void)write(STDOUT_FILENO, "Dump stats\n", 11);
+          g_should_dump_stats = 1;
         }
       ) == status_t::kFailure) return EXIT_FAILURE;
 #endif  // PRIVATE_DEBUG
 
   auto ret = mainLoop(fd, result.opts);
   if (ret == status_t::kFailure) return EXIT_FAILURE;
+  if (ret == status_t::kTimeout) return kExitTimeout;
 
   return EXIT_SUCCESS;
 }
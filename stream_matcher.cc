@@ -0,0 +1,43 @@
+/****************************************************************************
+ * stream_matcher.cc
+ *
+ *   Copyright (c) 2026 Yoshinori Sugino
+ *   This software is released under the MIT License.
+ ****************************************************************************/
+#include "stream_matcher.h"
+
+namespace util {
+
+StreamMatcher::StreamMatcher(const std::string &pattern)
+  : pattern_(pattern.begin(), pattern.end()),
+    failure_(pattern.size(), 0),
+    matched_(0) {
+  size_t length = 0;
+  for (size_t i = 1; i < pattern_.size(); ++i) {
+    while (length > 0 && pattern_[i] != pattern_[length])
+      length = failure_[length - 1];
+    if (pattern_[i] == pattern_[length]) ++length;
+    failure_[i] = length;
+  }
+}
+
+size_t StreamMatcher::Feed(const uint8_t *data, size_t size) {
+  if (pattern_.empty()) return 0;
+
+  for (size_t i = 0; i < size; ++i) {
+    while (matched_ > 0 && data[i] != pattern_[matched_])
+      matched_ = failure_[matched_ - 1];
+    if (data[i] == pattern_[matched_]) ++matched_;
+    if (matched_ == pattern_.size()) {
+      matched_ = 0;
+      return i + 1;
+    }
+  }
+  return 0;
+}
+
+void StreamMatcher::Reset() {
+  matched_ = 0;
+}
+
+}  // namespace util
@@ -0,0 +1,40 @@
+/****************************************************************************
+ * stream_matcher.h
+ *
+ *   Copyright (c) 2026 Yoshinori Sugino
+ *   This software is released under the MIT License.
+ ****************************************************************************/
+#ifndef STREAM_MATCHER_H_
+#define STREAM_MATCHER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace util {
+
+// Finds a fixed pattern in a byte stream which arrives in chunks
+// (Knuth-Morris-Pratt). A match may span several chunks.
+class StreamMatcher final {
+ public:
+  StreamMatcher() = delete;
+  explicit StreamMatcher(const std::string &pattern);
+
+  // Returns the number of bytes up to and including the end of the first
+  // match, or 0 when data completes no match
+  size_t Feed(const uint8_t *data, size_t size);
+  // Forgets a partial match
+  void Reset();
+
+ private:
+  std::vector<uint8_t> pattern_;
+  // Length of the longest proper prefix which is also a suffix of
+  // pattern_[0, i]
+  std::vector<size_t> failure_;
+  size_t matched_;
+};
+
+}  // namespace util
+
+#endif  // STREAM_MATCHER_H_
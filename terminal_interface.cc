@@ -6,8 +6,17 @@
  ****************************************************************************/
 #include "terminal_interface.h"
 
+#include <sys/ioctl.h>
+
+#ifdef __linux__
+#include <linux/serial.h>
+#endif  // __linux__
+
+#include <algorithm>
+#include <cstring>
 #include <map>
 
+#include "custom_baud_rate.h"
 #include "debug.h"
 
 namespace util {
@@ -34,6 +43,20 @@ const std::map<uint32_t, speed_t> kBaudRateMap = {
   {57600,  B57600 },
   {115200, B115200},
   {230400, B230400},
+#ifdef B460800
+  {460800,  B460800 },
+  {500000,  B500000 },
+  {576000,  B576000 },
+  {921600,  B921600 },
+  {1000000, B1000000},
+  {1152000, B1152000},
+  {1500000, B1500000},
+  {2000000, B2000000},
+  {2500000, B2500000},
+  {3000000, B3000000},
+  {3500000, B3500000},
+  {4000000, B4000000},
+#endif  // B460800
 };
 
 }  // namespace
@@ -41,7 +64,11 @@ const std::map<uint32_t, speed_t> kBaudRateMap = {
 TerminalInterface::TerminalInterface(const int32_t &fd)
   : fd_(fd),
     current_terminal_(),
-    backup_terminal_() {
+    backup_terminal_(),
+    output_baud_rate_(0),
+    input_baud_rate_(0),
+    uses_custom_baud_rate_(false),
+    is_low_latency_set_(false) {
       (void)TerminalInterface::BackupSettings();
 }
 
@@ -49,6 +76,7 @@ TerminalInterface::~TerminalInterface() {
   DEBUG_PRINTF("Call the destructor of TerminalInterface (fd: %d)", fd_);
   (void)Flush();
   (void)RevertSettings();
+  (void)RevertLowLatency();
 }
 
 common::status_t TerminalInterface::SetRawMode() {
@@ -58,9 +86,17 @@ common::status_t TerminalInterface::SetRawMode() {
 
 common::status_t TerminalInterface::SetBaudRate(const uint32_t &baud_rate,
                                                 direction_t direction) {
+  if (direction == direction_t::kIn) {
+    input_baud_rate_ = baud_rate;
+  } else if (direction == direction_t::kOut) {
+    output_baud_rate_ = baud_rate;
+  }
+
   auto itr = kBaudRateMap.find(baud_rate);
-  if (itr == kBaudRateMap.end())
-    return common::status_t::kFailure;
+  if (itr == kBaudRateMap.end()) {
+    uses_custom_baud_rate_ = true;
+    return common::status_t::kSuccess;
+  }
   if (direction == direction_t::kIn) {
     if (cfsetispeed(&current_terminal_, itr->second))
       return common::status_t::kFailure;
@@ -71,6 +107,55 @@ common::status_t TerminalInterface::SetBaudRate(const uint32_t &baud_rate,
   return common::status_t::kSuccess;
 }
 
+common::status_t TerminalInterface::SetFlowControl(
+    flow_control_t flow_control) {
+  current_terminal_.c_cflag &= ~CRTSCTS;
+  current_terminal_.c_iflag &= ~(IXON | IXOFF | IXANY);
+
+  if (flow_control == flow_control_t::kHardware) {
+    current_terminal_.c_cflag |= CRTSCTS;
+  } else if (flow_control == flow_control_t::kSoftware) {
+    // The kernel stops and restarts the output on XOFF/XON from the device,
+    // and sends them itself when its input buffer runs full
+    current_terminal_.c_iflag |= IXON | IXOFF;
+    current_terminal_.c_cc[VSTART] = 0x11;
+    current_terminal_.c_cc[VSTOP]  = 0x13;
+  }
+  return common::status_t::kSuccess;
+}
+
+common::status_t TerminalInterface::SetLowLatency() {
+#if defined(TIOCGSERIAL) && defined(ASYNC_LOW_LATENCY)
+  struct serial_struct serial;
+  if (ioctl(fd_, TIOCGSERIAL, &serial) == -1)
+    return common::status_t::kFailure;
+  if (serial.flags & ASYNC_LOW_LATENCY) return common::status_t::kSuccess;
+
+  serial.flags |= ASYNC_LOW_LATENCY;
+  if (ioctl(fd_, TIOCSSERIAL, &serial) == -1)
+    return common::status_t::kFailure;
+  is_low_latency_set_ = true;
+  return common::status_t::kSuccess;
+#else
+  return common::status_t::kFailure;
+#endif  // TIOCGSERIAL && ASYNC_LOW_LATENCY
+}
+
+common::status_t TerminalInterface::RevertLowLatency() {
+#if defined(TIOCGSERIAL) && defined(ASYNC_LOW_LATENCY)
+  if (!is_low_latency_set_) return common::status_t::kSuccess;
+
+  struct serial_struct serial;
+  if (ioctl(fd_, TIOCGSERIAL, &serial) == -1)
+    return common::status_t::kFailure;
+  serial.flags &= ~ASYNC_LOW_LATENCY;
+  if (ioctl(fd_, TIOCSSERIAL, &serial) == -1)
+    return common::status_t::kFailure;
+  is_low_latency_set_ = false;
+#endif  // TIOCGSERIAL && ASYNC_LOW_LATENCY
+  return common::status_t::kSuccess;
+}
+
 common::status_t TerminalInterface::Flush() {
   if (tcflush(fd_, TCIOFLUSH))
     return common::status_t::kFailure;
@@ -90,10 +175,45 @@ common::status_t TerminalInterface::RevertSettings() {
 }
 
 common::status_t TerminalInterface::SetNow() {
+  // A custom rate is applied together with the rest, because
+  // current_terminal_ has no rate for it and would hang up the line (B0)
+  if (uses_custom_baud_rate_) {
+    DEBUG_PRINTF("Use termios2 (output: %u, input: %u)", output_baud_rate_,
+                 input_baud_rate_);
+    TerminalSettings settings;
+    settings.input_flags   = current_terminal_.c_iflag;
+    settings.output_flags  = current_terminal_.c_oflag;
+    settings.control_flags = current_terminal_.c_cflag;
+    settings.local_flags   = current_terminal_.c_lflag;
+    settings.line          = current_terminal_.c_line;
+    std::memset(settings.control_chars, 0, sizeof(settings.control_chars));
+    std::memcpy(settings.control_chars, current_terminal_.c_cc,
+                std::min(sizeof(settings.control_chars),
+                         sizeof(current_terminal_.c_cc)));
+    return SetCustomBaudRate(fd_, settings, output_baud_rate_,
+                             input_baud_rate_);
+  }
+
   if (tcsetattr(fd_, TCSANOW, &current_terminal_))
     return common::status_t::kFailure;
   return common::status_t::kSuccess;
 }
 
+common::status_t TerminalInterface::GetBaudRate(uint32_t *baud_rate) const {
+  if (util::GetBaudRate(fd_, baud_rate) == common::status_t::kSuccess)
+    return common::status_t::kSuccess;
+
+  struct termios terminal;
+  if (tcgetattr(fd_, &terminal)) return common::status_t::kFailure;
+  auto speed = cfgetospeed(&terminal);
+  for (const auto &entry : kBaudRateMap) {
+    if (entry.second == speed) {
+      *baud_rate = entry.first;
+      return common::status_t::kSuccess;
+    }
+  }
+  return common::status_t::kFailure;
+}
+
 }  // namespace util
 
@@ -18,22 +18,42 @@ enum class direction_t : uint8_t {
   kOut
 };
 
+enum class flow_control_t : uint8_t {
+  kNone,
+  kHardware,  // RTS/CTS
+  kSoftware   // XON/XOFF
+};
+
 class TerminalInterface final {
  public:
   explicit TerminalInterface(const int32_t &);
   ~TerminalInterface();
 
   common::status_t SetRawMode();
+  // Rates missing from the table of Bxxx constants are set through
+  // termios2/BOTHER when the settings are applied
   common::status_t SetBaudRate(const uint32_t &, direction_t);
+  common::status_t SetFlowControl(flow_control_t);
+  // Asks the driver to pass data on at once (ASYNC_LOW_LATENCY) instead of
+  // batching it, e.g. for 16 ms in USB serial adapters. The driver flag is
+  // set immediately and restored by the destructor; kFailure means the
+  // driver does not support it.
+  common::status_t SetLowLatency();
   common::status_t SetNow();
+  // Reads back the output rate which the driver actually applied
+  common::status_t GetBaudRate(uint32_t *) const;
 
  private:
   common::status_t Flush();
   common::status_t RevertSettings();
   common::status_t BackupSettings();
+  common::status_t RevertLowLatency();
 
   int32_t fd_;
   struct termios current_terminal_, backup_terminal_;
+  uint32_t output_baud_rate_, input_baud_rate_;
+  bool uses_custom_baud_rate_;
+  bool is_low_latency_set_;
 };
 
 }  // namespace util
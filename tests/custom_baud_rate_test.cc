@@ -0,0 +1,74 @@
+/****************************************************************************
+ * tests/custom_baud_rate_test.cc
+ *
+ *   Sets a rate which has no Bxxx constant on a pseudo terminal, and fails
+ *   if the device is ever given B0 (which hangs up the line) on the way or
+ *   does not end up at the rate.
+ *
+ *   Copyright (c) 2026 Yoshinori Sugino
+ *   This software is released under the MIT License.
+ ****************************************************************************/
+#include <dlfcn.h>
+#include <pty.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <cstdlib>
+
+#include "terminal_interface.h"
+
+namespace {
+
+constexpr const uint32_t kCustomRate = 250000;
+
+// The test is single threaded
+int32_t hang_up_count = 0;
+
+}  // namespace
+
+// Replaces the one of the C library for terminal_interface.o, and counts
+// the settings which would hang up the line
+extern "C" int tcsetattr(int fd, int action, const struct termios *terminal) {
+  using tcsetattr_t = int (*)(int, int, const struct termios *);
+  static auto next =
+      reinterpret_cast<tcsetattr_t>(dlsym(RTLD_NEXT, "tcsetattr"));
+  if (cfgetospeed(terminal) == B0) ++hang_up_count;
+  return next(fd, action, terminal);
+}
+
+int main() {
+  int master, slave;
+  if (openpty(&master, &slave, nullptr, nullptr, nullptr) == -1)
+    return EXIT_FAILURE;
+
+  uint32_t applied_rate = 0;
+  {
+    util::TerminalInterface terminal(slave);
+    if (terminal.SetRawMode() == common::status_t::kFailure ||
+        terminal.SetBaudRate(kCustomRate, util::direction_t::kOut) ==
+            common::status_t::kFailure ||
+        terminal.SetBaudRate(0, util::direction_t::kIn) ==
+            common::status_t::kFailure ||
+        terminal.SetNow() == common::status_t::kFailure) {
+      fprintf(stderr, "the rate cannot be set\n");
+      return EXIT_FAILURE;
+    }
+    (void)terminal.GetBaudRate(&applied_rate);
+    // The destructor reverts the settings, which must not hang up either
+  }
+  close(slave);
+  close(master);
+
+  printf("custom_baud_rate: %u applied, B0 set %d times\n", applied_rate,
+         hang_up_count);
+  if (hang_up_count > 0) {
+    fprintf(stderr, "the line is hung up while a custom rate is set\n");
+    return EXIT_FAILURE;
+  }
+  if (applied_rate != kCustomRate) {
+    fprintf(stderr, "the custom rate is not applied\n");
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
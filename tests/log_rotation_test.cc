@@ -0,0 +1,114 @@
+/****************************************************************************
+ * tests/log_rotation_test.cc
+ *
+ *   Rotates the session log after its directory has become unwritable,
+ *   and fails if stermcom does not log again once the directory is
+ *   writable, or does not exit when it is asked to.
+ *
+ *   Copyright (c) 2026 Yoshinori Sugino
+ *   This software is released under the MIT License.
+ ****************************************************************************/
+#include <poll.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "bench/pty_harness.h"
+
+namespace {
+
+constexpr const size_t kMaxLogSize      = 1024;
+constexpr const uint32_t kStopTimeoutMs = 3000;
+// Longer than stermcom waits to open the log again
+constexpr const uint32_t kReopenWaitMs  = 1500;
+
+// Writes size bytes as the device and discards what stermcom prints
+void receive(const bench::PtySession &session, size_t size) {
+  std::vector<uint8_t> data(size, 'x');
+  uint8_t buffer[4096];
+  size_t written = 0;
+  auto start = bench::NowNs();
+  while (bench::NowNs() - start < 500ULL * 1000000) {
+    if (written < size) {
+      auto ret = write(session.device(), data.data() + written,
+                       size - written);
+      if (ret > 0) written += ret;
+    }
+    struct pollfd fds = {session.output(), POLLIN, 0};
+    if (poll(&fds, 1, 10) > 0)
+      (void)read(session.output(), buffer, sizeof(buffer));
+  }
+}
+
+void removeAll(const std::string &directory, const std::string &log_path) {
+  (void)chmod(directory.c_str(), 0755);
+  (void)unlink(log_path.c_str());
+  (void)unlink((log_path + ".1").c_str());
+  (void)rmdir(directory.c_str());
+}
+
+}  // namespace
+
+int main(int argc, char *argv[]) {
+  if (argc < 2) {
+    printf("USAGE: %s stermcom [options]\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  char directory_template[] = "/tmp/stermcom-log-XXXXXX";
+  if (mkdtemp(directory_template) == nullptr) return EXIT_FAILURE;
+  const std::string directory(directory_template);
+  const auto log_path = directory + "/session.log";
+
+  std::vector<std::string> options(argv + 2, argv + argc);
+  options.push_back("--log=" + log_path);
+  options.push_back("--log-max-size=" + std::to_string(kMaxLogSize));
+  options.push_back("--log-keep=1");
+  bench::PtySession session(argv[1], options);
+  if (!session.WaitReady(5000)) {
+    printf("stermcom did not start\n");
+    removeAll(directory, log_path);
+    return EXIT_FAILURE;
+  }
+
+  // Fills the log, so that the next bytes rotate it
+  receive(session, kMaxLogSize);
+  // Permissions do not stop root, so the directory is removed instead
+  if (geteuid() == 0) {
+    removeAll(directory, log_path);
+  } else {
+    (void)chmod(directory.c_str(), 0555);
+  }
+  receive(session, kMaxLogSize);
+
+  // Then the directory is writable again
+  if (geteuid() == 0) {
+    (void)mkdir(directory.c_str(), 0755);
+  } else {
+    (void)chmod(directory.c_str(), 0755);
+  }
+  usleep(kReopenWaitMs * 1000);
+  receive(session, kMaxLogSize / 2);
+
+  struct rusage usage;
+  auto is_stopped = session.Stop(&usage, kStopTimeoutMs);
+  struct stat st;
+  auto log_size = stat(log_path.c_str(), &st) == 0 ? st.st_size : 0;
+  removeAll(directory, log_path);
+  if (!is_stopped) {
+    fprintf(stderr, "stermcom hangs after the log could not be reopened\n");
+    return EXIT_FAILURE;
+  }
+  printf("log_rotation: %lld bytes logged after the reopen, %.3f CPU "
+         "seconds\n", static_cast<long long>(log_size),
+         bench::CpuSeconds(usage));
+  if (log_size == 0) {
+    fprintf(stderr, "nothing is logged after the directory is writable\n");
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
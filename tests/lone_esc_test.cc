@@ -0,0 +1,85 @@
+/****************************************************************************
+ * tests/lone_esc_test.cc
+ *
+ *   Types a lone ESC while the device prints every 10 ms, and fails if it
+ *   does not reach the device soon after the key sequence timeout.
+ *
+ *   Copyright (c) 2026 Yoshinori Sugino
+ *   This software is released under the MIT License.
+ ****************************************************************************/
+#include <poll.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "bench/pty_harness.h"
+
+namespace {
+
+constexpr const int32_t kPrintIntervalMs = 10;
+constexpr const uint64_t kMaxDelayNs     = 500ULL * 1000000;
+constexpr const uint64_t kGiveUpNs       = 2000ULL * 1000000;
+
+}  // namespace
+
+int main(int argc, char *argv[]) {
+  if (argc < 2) {
+    printf("USAGE: %s stermcom [options]\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  std::vector<std::string> options(argv + 2, argv + argc);
+  bench::PtySession session(argv[1], options);
+  if (!session.WaitReady(5000)) {
+    printf("stermcom did not start\n");
+    return EXIT_FAILURE;
+  }
+
+  const uint8_t esc = 0x1b;
+  if (write(session.terminal(), &esc, 1) != 1) return EXIT_FAILURE;
+  auto start = bench::NowNs();
+
+  uint64_t arrived_ns = 0;
+  uint64_t printed_ns = 0;
+  uint8_t buffer[4096];
+  while (arrived_ns == 0 && bench::NowNs() - start < kGiveUpNs) {
+    if (bench::NowNs() - printed_ns >= kPrintIntervalMs * 1000000ULL) {
+      const char line[] = "busy\r\n";
+      (void)write(session.device(), line, sizeof(line) - 1);
+      printed_ns = bench::NowNs();
+    }
+
+    struct pollfd fds[2] = {
+      {session.device(), POLLIN, 0},
+      {session.output(), POLLIN, 0},
+    };
+    if (poll(fds, 2, 1) <= 0) continue;
+    if (fds[0].revents & POLLIN) {
+      auto ret = read(session.device(), buffer, sizeof(buffer));
+      for (ssize_t i = 0; i < ret; ++i) {
+        if (buffer[i] == esc) arrived_ns = bench::NowNs();
+      }
+    }
+    // What the device printed is discarded
+    if (fds[1].revents & POLLIN)
+      (void)read(session.output(), buffer, sizeof(buffer));
+  }
+
+  struct rusage usage;
+  if (!session.Stop(&usage)) return EXIT_FAILURE;
+
+  if (arrived_ns == 0) {
+    fprintf(stderr, "a lone ESC is held while the device prints\n");
+    return EXIT_FAILURE;
+  }
+  auto delay_ns = arrived_ns - start;
+  printf("lone_esc: sent after %.1f ms\n", delay_ns / 1e6);
+  if (delay_ns > kMaxDelayNs) {
+    fprintf(stderr, "a lone ESC is sent too late\n");
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
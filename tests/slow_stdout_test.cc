@@ -0,0 +1,84 @@
+/****************************************************************************
+ * tests/slow_stdout_test.cc
+ *
+ *   Receives while a non-blocking pipe on stdout is not read, and fails if
+ *   stermcom burns CPU time meanwhile or loses bytes.
+ *
+ *   Copyright (c) 2026 Yoshinori Sugino
+ *   This software is released under the MIT License.
+ ****************************************************************************/
+#include <poll.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "bench/pty_harness.h"
+
+namespace {
+
+constexpr const size_t kReceiveSize   = 1024 * 1024;
+constexpr const uint32_t kStallMs     = 2000;
+constexpr const double kMaxCpuSeconds = 0.2;
+
+}  // namespace
+
+int main(int argc, char *argv[]) {
+  if (argc < 2) {
+    printf("USAGE: %s stermcom [options]\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  std::vector<std::string> options(argv + 2, argv + argc);
+  bench::PtySession session(argv[1], options,
+                            bench::PtySession::kPipeStdout |
+                                bench::PtySession::kNonblockStdout);
+  if (!session.WaitReady(5000)) {
+    printf("stermcom did not start\n");
+    return EXIT_FAILURE;
+  }
+
+  // The device sends until stdout, which nobody reads, and the tty are full
+  std::vector<uint8_t> data(kReceiveSize, 'x');
+  size_t written = 0;
+  auto start = bench::NowNs();
+  while (written < kReceiveSize &&
+         bench::NowNs() - start < kStallMs * 1000000ULL) {
+    auto ret = write(session.device(), data.data() + written,
+                     kReceiveSize - written);
+    if (ret > 0) {
+      written += ret;
+    } else {
+      usleep(1000);
+    }
+  }
+  while (bench::NowNs() - start < kStallMs * 1000000ULL) usleep(10000);
+
+  // Then everything sent has to arrive
+  size_t received = 0;
+  uint8_t buffer[65536];
+  while (received < written) {
+    struct pollfd fds = {session.output(), POLLIN, 0};
+    if (poll(&fds, 1, 1000) <= 0) break;
+    auto ret = read(session.output(), buffer, sizeof(buffer));
+    if (ret <= 0) break;
+    received += ret;
+  }
+
+  struct rusage usage;
+  if (!session.Stop(&usage)) return EXIT_FAILURE;
+  auto cpu = bench::CpuSeconds(usage);
+  printf("slow_stdout: %zu of %zu bytes received, %.3f CPU seconds\n",
+         received, written, cpu);
+  if (received != written) {
+    fprintf(stderr, "received bytes were lost\n");
+    return EXIT_FAILURE;
+  }
+  if (cpu > kMaxCpuSeconds) {
+    fprintf(stderr, "stermcom spins while stdout is full\n");
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
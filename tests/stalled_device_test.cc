@@ -0,0 +1,70 @@
+/****************************************************************************
+ * tests/stalled_device_test.cc
+ *
+ *   Pipes input into stermcom whose device is never read, and fails if it
+ *   burns CPU time after the producer has closed the pipe.
+ *
+ *   Copyright (c) 2026 Yoshinori Sugino
+ *   This software is released under the MIT License.
+ ****************************************************************************/
+#include <poll.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "bench/pty_harness.h"
+
+namespace {
+
+constexpr const size_t kInputSize       = 1024 * 1024;
+// The input is written until stermcom stops taking it for this long
+constexpr const int32_t kStallTimeoutMs = 200;
+constexpr const uint32_t kSeconds       = 2;
+constexpr const double kMaxCpuSeconds   = 0.2;
+
+}  // namespace
+
+int main(int argc, char *argv[]) {
+  if (argc < 2) {
+    printf("USAGE: %s stermcom [options]\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  std::vector<std::string> options(argv + 2, argv + argc);
+  bench::PtySession session(argv[1], options,
+                            bench::PtySession::kPipeStdin);
+  if (!session.WaitReady(5000)) {
+    printf("stermcom did not start\n");
+    return EXIT_FAILURE;
+  }
+
+  // Fills the outbound buffer and the device, and then exits like a
+  // producer would
+  std::vector<uint8_t> chunk(64 * 1024, 'x');
+  size_t written = 0;
+  while (written < kInputSize) {
+    struct pollfd fds = {session.input(), POLLOUT, 0};
+    if (poll(&fds, 1, kStallTimeoutMs) <= 0) break;
+    auto ret = write(session.input(), chunk.data(), chunk.size());
+    if (ret > 0) written += ret;
+  }
+  session.CloseInput();
+
+  auto start = bench::NowNs();
+  sleep(kSeconds);
+  struct rusage usage;
+  if (!session.Stop(&usage)) return EXIT_FAILURE;
+  auto elapsed = (bench::NowNs() - start) / 1e9;
+
+  auto cpu = bench::CpuSeconds(usage);
+  printf("stalled_device: %zu bytes piped, %.3f CPU seconds in %.3f s\n",
+         written, cpu, elapsed);
+  if (cpu > kMaxCpuSeconds) {
+    fprintf(stderr, "stermcom spins while the device is stalled\n");
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,129 @@
+/****************************************************************************
+ * trigger_table.cc
+ *
+ *   Copyright (c) 2026 Yoshinori Sugino
+ *   This software is released under the MIT License.
+ ****************************************************************************/
+#include "trigger_table.h"
+
+#include <fstream>
+
+namespace util {
+
+namespace {
+
+int32_t hexValue(char c) {
+  if (c >= '0' && c <= '9') return c - '0';
+  if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+  if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+  return -1;
+}
+
+bool unescape(const std::string &str, std::string *result) {
+  result->clear();
+  for (size_t i = 0; i < str.size(); ++i) {
+    if (str[i] != '\\') {
+      result->push_back(str[i]);
+      continue;
+    }
+    if (++i == str.size()) return false;
+    switch (str[i]) {
+      case 'r':  result->push_back('\r');   break;
+      case 'n':  result->push_back('\n');   break;
+      case 't':  result->push_back('\t');   break;
+      case 'e':  result->push_back('\x1b'); break;
+      case '\\': result->push_back('\\');   break;
+      case 'x': {
+        if (i + 2 >= str.size()) return false;
+        auto high = hexValue(str[i + 1]);
+        auto low  = hexValue(str[i + 2]);
+        if (high < 0 || low < 0) return false;
+        result->push_back(static_cast<char>(high << 4 | low));
+        i += 2;
+        break;
+      }
+      default: return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
+TriggerTable::TriggerTable()
+  : triggers_(),
+    error_() {
+}
+
+common::status_t TriggerTable::Load(const std::string &path) {
+  std::ifstream ifs(path);
+  if (!ifs) {
+    error_ = "cannot open " + path;
+    return common::status_t::kFailure;
+  }
+
+  std::string line;
+  uint32_t line_number = 0;
+  while (std::getline(ifs, line)) {
+    ++line_number;
+    if (!line.empty() && line.back() == '\r') line.pop_back();
+    if (line.empty() || line[0] == '#') continue;
+    if (ParseLine(line) == common::status_t::kFailure) {
+      error_ = path + ":" + std::to_string(line_number) + ": " + error_;
+      return common::status_t::kFailure;
+    }
+  }
+  return common::status_t::kSuccess;
+}
+
+const std::vector<Trigger> &TriggerTable::Triggers() const {
+  return triggers_;
+}
+
+std::vector<std::string> TriggerTable::Patterns() const {
+  std::vector<std::string> patterns;
+  patterns.reserve(triggers_.size());
+  for (const auto &trigger : triggers_) patterns.push_back(trigger.pattern);
+  return patterns;
+}
+
+const std::string &TriggerTable::Error() const {
+  return error_;
+}
+
+common::status_t TriggerTable::ParseLine(const std::string &line) {
+  auto tab = line.find('\t');
+  if (tab == std::string::npos) {
+    error_ = "no tab after the pattern";
+    return common::status_t::kFailure;
+  }
+
+  Trigger trigger;
+  if (!unescape(line.substr(0, tab), &trigger.pattern) ||
+      trigger.pattern.empty()) {
+    error_ = "incorrect pattern";
+    return common::status_t::kFailure;
+  }
+
+  auto action = line.substr(tab + 1);
+  auto space  = action.find(' ');
+  auto name   = action.substr(0, space);
+  if (name == "send") {
+    trigger.action = trigger_action_t::kSend;
+  } else if (name == "mark") {
+    trigger.action = trigger_action_t::kMark;
+  } else {
+    error_ = "unknown action \"" + name + "\"";
+    return common::status_t::kFailure;
+  }
+  if (space != std::string::npos &&
+      !unescape(action.substr(space + 1), &trigger.text)) {
+    error_ = "incorrect text";
+    return common::status_t::kFailure;
+  }
+
+  triggers_.push_back(trigger);
+  return common::status_t::kSuccess;
+}
+
+}  // namespace util
@@ -0,0 +1,60 @@
+/****************************************************************************
+ * trigger_table.h
+ *
+ *   Copyright (c) 2026 Yoshinori Sugino
+ *   This software is released under the MIT License.
+ ****************************************************************************/
+#ifndef TRIGGER_TABLE_H_
+#define TRIGGER_TABLE_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "common_type.h"
+
+namespace util {
+
+enum class trigger_action_t : uint8_t {
+  kSend,  // Queue the text for the device
+  kMark   // Report the text locally
+};
+
+struct Trigger {
+  std::string pattern;
+  trigger_action_t action;
+  std::string text;
+
+  Trigger()
+    : pattern(), action(trigger_action_t::kSend), text() {}
+};
+
+// Reads a trigger file. Each line holds a pattern, a tab, an action
+// ("send" or "mark"), a space and the text of the action:
+//
+//   Hit any key to stop autoboot<TAB>send \r
+//   login:<TAB>send root\n
+//   Kernel panic<TAB>mark panic
+//
+// Patterns and texts may contain \r, \n, \t, \e, \\ and \xHH.
+// Empty lines and lines starting with # are ignored.
+class TriggerTable final {
+ public:
+  TriggerTable();
+
+  // On failure, Error() tells which line is wrong
+  common::status_t Load(const std::string &path);
+  const std::vector<Trigger> &Triggers() const;
+  std::vector<std::string> Patterns() const;
+  const std::string &Error() const;
+
+ private:
+  common::status_t ParseLine(const std::string &line);
+
+  std::vector<Trigger> triggers_;
+  std::string error_;
+};
+
+}  // namespace util
+
+#endif  // TRIGGER_TABLE_H_
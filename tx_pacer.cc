@@ -0,0 +1,142 @@
+/****************************************************************************
+ * tx_pacer.cc
+ *
+ *   Copyright (c) 2026 Yoshinori Sugino
+ *   This software is released under the MIT License.
+ ****************************************************************************/
+#include "tx_pacer.h"
+
+#include <sys/timerfd.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cmath>
+
+#include "debug.h"
+
+namespace util {
+
+namespace {
+
+constexpr uint64_t kNsPerSec = 1000000000;
+// The bucket holds the bytes of this period, so that the writes are not
+// split into single bytes
+constexpr uint64_t kBurstNs = 20000000;
+
+uint64_t nowNs() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return static_cast<uint64_t>(ts.tv_sec) * kNsPerSec + ts.tv_nsec;
+}
+
+}  // namespace
+
+TxPacer::TxPacer(const Settings &settings)
+  : settings_(settings),
+    timer_fd_(-1),
+    burst_(std::max(1.0, static_cast<double>(settings.bytes_per_sec) *
+                             kBurstNs / kNsPerSec)),
+    tokens_(burst_),
+    refilled_ns_(0),
+    sent_ns_(0),
+    is_line_end_(false),
+    is_cr_(false) {
+}
+
+TxPacer::~TxPacer() {
+  if (timer_fd_ != -1) close(timer_fd_);
+}
+
+bool TxPacer::IsEnabled() const {
+  return settings_.bytes_per_sec != 0 || settings_.char_delay_ns != 0 ||
+         settings_.line_delay_ns != 0;
+}
+
+common::status_t TxPacer::Open() {
+  timer_fd_ = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC | TFD_NONBLOCK);
+  if (timer_fd_ == -1) return common::status_t::kFailure;
+  refilled_ns_ = nowNs();
+  return common::status_t::kSuccess;
+}
+
+int32_t TxPacer::TimerFd() const {
+  return timer_fd_;
+}
+
+void TxPacer::Acknowledge() {
+  uint64_t expirations;
+  (void)read(timer_fd_, &expirations, sizeof(expirations));
+}
+
+bool TxPacer::IsReady(const ByteRingBuffer &buffer) {
+  if (buffer.Empty()) return false;
+
+  auto now_ns   = nowNs();
+  auto ready_ns = now_ns;
+
+  if (settings_.bytes_per_sec != 0) {
+    Refill(now_ns);
+    if (tokens_ < 1.0)
+      ready_ns += static_cast<uint64_t>(std::ceil(
+          (1.0 - tokens_) * kNsPerSec / settings_.bytes_per_sec));
+  }
+  if (settings_.char_delay_ns != 0)
+    ready_ns = std::max(ready_ns, sent_ns_ + settings_.char_delay_ns);
+  // LF right after CR belongs to the same line end
+  if (settings_.line_delay_ns != 0 && is_line_end_ &&
+      !(is_cr_ && buffer.At(0) == '\n'))
+    ready_ns = std::max(ready_ns, sent_ns_ + settings_.line_delay_ns);
+
+  if (ready_ns <= now_ns) return true;
+
+  struct itimerspec its{};
+  its.it_value.tv_sec  = ready_ns / kNsPerSec;
+  its.it_value.tv_nsec = ready_ns % kNsPerSec;
+  if (timerfd_settime(timer_fd_, TFD_TIMER_ABSTIME, &its, nullptr) == -1)
+    DEBUG_PRINTF("Fail to arm the pacing timer");
+  return false;
+}
+
+ssize_t TxPacer::WriteTo(ByteRingBuffer &buffer, const int32_t &fd) {
+  auto now_ns = nowNs();
+  auto size   = buffer.Size();
+
+  if (settings_.bytes_per_sec != 0) {
+    Refill(now_ns);
+    size = std::min(size, static_cast<size_t>(tokens_));
+  }
+  if (settings_.char_delay_ns != 0) size = std::min<size_t>(size, 1);
+
+  // A write ends at a line terminator, so that the next line waits
+  auto line_end = SIZE_MAX;
+  if (settings_.line_delay_ns != 0) {
+    line_end = std::min(buffer.Find('\r', size), buffer.Find('\n', size));
+    if (line_end < size) {
+      if (buffer.At(line_end) == '\r' && line_end + 1 < size &&
+          buffer.At(line_end + 1) == '\n')
+        ++line_end;
+      size = line_end + 1;
+    }
+  }
+  auto is_cr = line_end < size && buffer.At(line_end) == '\r';
+
+  auto ret = buffer.WriteTo(fd, size);
+  if (ret <= 0) return ret;
+
+  if (settings_.bytes_per_sec != 0) tokens_ -= ret;
+  sent_ns_     = now_ns;
+  is_line_end_ = static_cast<size_t>(ret) == line_end + 1;
+  is_cr_       = is_line_end_ && is_cr;
+  return ret;
+}
+
+void TxPacer::Refill(uint64_t now_ns) {
+  tokens_ = std::min(burst_, tokens_ + static_cast<double>(now_ns -
+                                                           refilled_ns_) *
+                                           settings_.bytes_per_sec /
+                                           kNsPerSec);
+  refilled_ns_ = now_ns;
+}
+
+}  // namespace util
@@ -0,0 +1,70 @@
+/****************************************************************************
+ * tx_pacer.h
+ *
+ *   Copyright (c) 2026 Yoshinori Sugino
+ *   This software is released under the MIT License.
+ ****************************************************************************/
+#ifndef TX_PACER_H_
+#define TX_PACER_H_
+
+#include <sys/types.h>
+
+#include <cstddef>
+#include <cstdint>
+
+#include "byte_ring_buffer.h"
+#include "common_type.h"
+
+namespace util {
+
+// Limits how fast the outbound buffer is written to the device, for
+// consumers without flow control. Waiting is done with a timerfd, which
+// the caller polls instead of waiting for the device to become writable.
+class TxPacer final {
+ public:
+  struct Settings {
+    uint64_t bytes_per_sec;   // Token bucket rate (0: unlimited)
+    uint64_t char_delay_ns;   // Between two bytes
+    uint64_t line_delay_ns;   // Before the first byte of a line
+
+    Settings()
+      : bytes_per_sec(0), char_delay_ns(0), line_delay_ns(0) {}
+  };
+
+  TxPacer() = delete;
+  explicit TxPacer(const Settings &settings);
+  ~TxPacer();
+  TxPacer(const TxPacer &) = delete;
+  TxPacer &operator=(const TxPacer &) = delete;
+
+  bool IsEnabled() const;
+  common::status_t Open();
+  // Becomes readable when the time to send has come
+  int32_t TimerFd() const;
+  void Acknowledge();
+
+  // Returns true when the front of buffer may be sent now. Otherwise the
+  // timer is armed for the time when it may.
+  bool IsReady(const ByteRingBuffer &buffer);
+  // Writes as much of buffer as the pacing allows now.
+  // Returns the result of ByteRingBuffer::WriteTo().
+  ssize_t WriteTo(ByteRingBuffer &buffer, const int32_t &fd);
+
+ private:
+  void Refill(uint64_t now_ns);
+
+  Settings settings_;
+  int32_t timer_fd_;
+  // Bucket capacity and content in bytes
+  double burst_;
+  double tokens_;
+  uint64_t refilled_ns_;
+  uint64_t sent_ns_;
+  // A line terminator was the last byte sent, and whether it was CR
+  bool is_line_end_;
+  bool is_cr_;
+};
+
+}  // namespace util
+
+#endif  // TX_PACER_H_
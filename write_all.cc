@@ -0,0 +1,37 @@
+/****************************************************************************
+ * write_all.cc
+ *
+ *   Copyright (c) 2026 Yoshinori Sugino
+ *   This software is released under the MIT License.
+ ****************************************************************************/
+#include "write_all.h"
+
+#include <poll.h>
+#include <unistd.h>
+
+#include <cerrno>
+
+namespace util {
+
+common::status_t WriteAll(const int32_t &fd, const uint8_t *data,
+                          size_t size) {
+  while (size > 0) {
+    auto ret = write(fd, data, size);
+    if (ret > 0) {
+      data += ret;
+      size -= ret;
+      continue;
+    }
+    if (ret == -1 && errno == EINTR) continue;
+    if (ret == -1 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+      struct pollfd pfd{fd, POLLOUT, 0};
+      if (poll(&pfd, 1, -1) == -1 && errno != EINTR)
+        return common::status_t::kFailure;
+      continue;
+    }
+    return common::status_t::kFailure;
+  }
+  return common::status_t::kSuccess;
+}
+
+}  // namespace util
@@ -0,0 +1,23 @@
+/****************************************************************************
+ * write_all.h
+ *
+ *   Copyright (c) 2026 Yoshinori Sugino
+ *   This software is released under the MIT License.
+ ****************************************************************************/
+#ifndef WRITE_ALL_H_
+#define WRITE_ALL_H_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "common_type.h"
+
+namespace util {
+
+// Writes all bytes, also to a non-blocking descriptor (waits until it
+// becomes writable again)
+common::status_t WriteAll(const int32_t &fd, const uint8_t *data, size_t size);
+
+}  // namespace util
+
+#endif  // WRITE_ALL_H_